@@ -0,0 +1,379 @@
+#include <stddef.h>
+#include "main.h"
+
+#define ALIAS_MIN_SLOTS 64
+#define ALIAS_MAX_DEPTH 64
+
+/**
+ * struct interned - a string stored once, prefixed by its length
+ * @len: length of the string
+ * @hash: hash of the string
+ * @str: the NUL-terminated string itself
+ */
+typedef struct interned
+{
+	size_t len;
+	unsigned long hash;
+	char str[];
+} interned_t;
+
+static interned_t **intern_slots;
+static size_t intern_capacity;
+static size_t intern_count;
+
+static alias_t *alias_entries;
+static size_t alias_count;
+static size_t alias_entries_size;
+static int *alias_slots;
+static size_t alias_capacity;
+static unsigned long alias_expansions;
+static unsigned long alias_expand_ns;
+
+/**
+ * string_hash - hashes a string (FNV-1a)
+ * @str: string to hash
+ * @len: length of the string
+ * Return: hash value
+ */
+static unsigned long string_hash(const char *str, size_t len)
+{
+	unsigned long hash = 2166136261UL;
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		hash = (hash ^ (unsigned char)str[i]) * 16777619UL;
+	return (hash);
+}
+
+/**
+ * alias_xcalloc - allocates zeroed memory or exits
+ * @count: number of elements
+ * @size: size of one element
+ * Return: pointer to the memory
+ */
+static void *alias_xcalloc(size_t count, size_t size)
+{
+	void *memory = calloc(count, size);
+
+	if (memory == NULL)
+	{
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+	return (memory);
+}
+
+/**
+ * intern_grow - doubles the intern pool and rehashes it
+ */
+static void intern_grow(void)
+{
+	interned_t **old = intern_slots;
+	size_t old_capacity = intern_capacity, i, slot;
+
+	intern_capacity = old_capacity ? old_capacity * 2 : ALIAS_MIN_SLOTS;
+	intern_slots = alias_xcalloc(intern_capacity, sizeof(*intern_slots));
+
+	for (i = 0; i < old_capacity; i++)
+	{
+		if (old[i] == NULL)
+			continue;
+		slot = old[i]->hash & (intern_capacity - 1);
+		while (intern_slots[slot] != NULL)
+			slot = (slot + 1) & (intern_capacity - 1);
+		intern_slots[slot] = old[i];
+	}
+	free(old);
+}
+
+/**
+ * intern_string - returns the single shared copy of a string
+ * @str: string to intern, not necessarily NUL-terminated
+ * @len: length of the string
+ *
+ * Interned strings are never freed; equal strings share one copy,
+ * so values repeated across thousands of aliases are stored once.
+ * Return: the interned string
+ */
+const char *intern_string(const char *str, size_t len)
+{
+	unsigned long hash = string_hash(str, len);
+	interned_t *interned;
+	size_t slot;
+
+	if ((intern_count + 1) * 2 > intern_capacity)
+		intern_grow();
+
+	slot = hash & (intern_capacity - 1);
+	while ((interned = intern_slots[slot]) != NULL)
+	{
+		if (interned->hash == hash && interned->len == len &&
+		    memcmp(interned->str, str, len) == 0)
+			return (interned->str);
+		slot = (slot + 1) & (intern_capacity - 1);
+	}
+
+	interned = alias_xcalloc(1, sizeof(*interned) + len + 1);
+	interned->len = len;
+	interned->hash = hash;
+	memcpy(interned->str, str, len);
+	intern_slots[slot] = interned;
+	intern_count++;
+	return (interned->str);
+}
+
+/**
+ * interned_length - length of an interned string, without scanning it
+ * @str: string returned by intern_string
+ * Return: length of the string
+ */
+size_t interned_length(const char *str)
+{
+	return (((const interned_t *)(str - offsetof(interned_t, str)))->len);
+}
+
+/**
+ * interned_hash - hash of an interned string, without rehashing it
+ * @str: string returned by intern_string
+ * Return: hash of the string
+ */
+static unsigned long interned_hash(const char *str)
+{
+	return (((const interned_t *)(str - offsetof(interned_t, str)))->hash);
+}
+
+/**
+ * alias_grow - doubles the alias index and rehashes it
+ */
+static void alias_grow(void)
+{
+	size_t i, slot;
+
+	free(alias_slots);
+	alias_capacity = alias_capacity ? alias_capacity * 2 : ALIAS_MIN_SLOTS;
+	alias_slots = alias_xcalloc(alias_capacity, sizeof(*alias_slots));
+	for (i = 0; i < alias_capacity; i++)
+		alias_slots[i] = -1;
+
+	for (i = 0; i < alias_count; i++)
+	{
+		slot = interned_hash(alias_entries[i].name) & (alias_capacity - 1);
+		while (alias_slots[slot] != -1)
+			slot = (slot + 1) & (alias_capacity - 1);
+		alias_slots[slot] = i;
+	}
+}
+
+/**
+ * alias_slot - finds the index slot of an alias name
+ * @name: alias name
+ * @len: length of the name
+ * @hash: hash of the name
+ * Return: slot holding the alias, or the empty slot where it belongs
+ */
+static size_t alias_slot(const char *name, size_t len, unsigned long hash)
+{
+	size_t slot = hash & (alias_capacity - 1);
+	const char *entry;
+
+	while (alias_slots[slot] != -1)
+	{
+		entry = alias_entries[alias_slots[slot]].name;
+		if (interned_hash(entry) == hash && interned_length(entry) == len &&
+		    memcmp(entry, name, len) == 0)
+			break;
+		slot = (slot + 1) & (alias_capacity - 1);
+	}
+	return (slot);
+}
+
+/**
+ * find_alias - looks up an alias by name
+ * @name: alias name
+ * Return: the alias, NULL if there is none
+ */
+alias_t *find_alias(const char *name)
+{
+	size_t slot, len;
+
+	if (alias_count == 0)
+		return (NULL);
+
+	len = strlen(name);
+	slot = alias_slot(name, len, string_hash(name, len));
+	if (alias_slots[slot] == -1)
+		return (NULL);
+	return (&alias_entries[alias_slots[slot]]);
+}
+
+/**
+ * tokenize_alias - splits an alias value into interned tokens
+ * @alias: alias whose value is tokenized
+ *
+ * This runs once per definition, so expanding the alias later only
+ * copies token pointers.
+ */
+static void tokenize_alias(alias_t *alias)
+{
+	const char *p = alias->value, *start;
+	int count = 0;
+
+	free(alias->tokens);
+	alias->tokens = alias_xcalloc(interned_length(alias->value) / 2 + 1,
+				      sizeof(*alias->tokens));
+
+	while (*p != '\0')
+	{
+		if (*p == ' ' || *p == '\t')
+		{
+			p++;
+			continue;
+		}
+		start = p;
+		while (*p != '\0' && *p != ' ' && *p != '\t')
+			p++;
+		alias->tokens[count++] = intern_string(start, p - start);
+	}
+	alias->token_count = count;
+}
+
+/**
+ * add_alias - adds or updates an alias
+ * @name: alias name
+ * @value: alias value
+ */
+void add_alias(char *name, char *value)
+{
+	size_t slot, len = strlen(name);
+	alias_t *grown;
+
+	if ((alias_count + 1) * 2 > alias_capacity)
+		alias_grow();
+
+	slot = alias_slot(name, len, string_hash(name, len));
+	if (alias_slots[slot] != -1)
+	{
+		alias_entries[alias_slots[slot]].value =
+			intern_string(value, strlen(value));
+		tokenize_alias(&alias_entries[alias_slots[slot]]);
+		return;
+	}
+
+	if (alias_count == alias_entries_size)
+	{
+		alias_entries_size = alias_entries_size ? alias_entries_size * 2
+			: ALIAS_MIN_SLOTS;
+		grown = realloc(alias_entries,
+				alias_entries_size * sizeof(*alias_entries));
+		if (grown == NULL)
+		{
+			perror("malloc");
+			exit(EXIT_FAILURE);
+		}
+		alias_entries = grown;
+	}
+
+	alias_entries[alias_count].name = intern_string(name, len);
+	alias_entries[alias_count].value = intern_string(value, strlen(value));
+	alias_entries[alias_count].tokens = NULL;
+	tokenize_alias(&alias_entries[alias_count]);
+	alias_slots[slot] = alias_count++;
+}
+
+/**
+ * expand_alias - replaces an alias in command position by its tokens
+ * @args: command arguments
+ *
+ * Chained aliases are followed until the command word is not an
+ * alias, or is an alias already expanded for this command. The time
+ * spent is only measured while the shellstat histograms are on.
+ * Return: the expanded arguments, allocated in the arena, or @args
+ * itself when there is no alias to expand
+ */
+char **expand_alias(char **args)
+{
+	alias_t *alias, *seen[ALIAS_MAX_DEPTH];
+	long long start;
+	int depth = 0, argc, i;
+	char **expanded;
+
+	if (alias_count == 0 || args[0] == NULL)
+		return (args);
+
+	start = stats_enabled ? monotonic_ns() : 0;
+	while (args[0] != NULL && depth < ALIAS_MAX_DEPTH &&
+	       (alias = find_alias(args[0])) != NULL)
+	{
+		/* A name that expands back into itself stops the chain */
+		for (i = 0; i < depth && seen[i] != alias; i++)
+			;
+		if (i < depth)
+			break;
+		seen[depth++] = alias;
+
+		for (argc = 1; args[argc] != NULL; argc++)
+			;
+		expanded = arena_alloc((alias->token_count + argc) * sizeof(*expanded));
+		memcpy(expanded, alias->tokens, alias->token_count * sizeof(*expanded));
+		memcpy(expanded + alias->token_count, args + 1, argc * sizeof(*args));
+		args = expanded;
+	}
+	if (start != 0)
+	{
+		alias_expansions++;
+		alias_expand_ns += monotonic_ns() - start;
+	}
+	return (args);
+}
+
+/**
+ * alias_expansion_stats - reports the time spent expanding aliases
+ * @count: set to the number of commands checked for aliases
+ * @ns: set to the total expansion time, in nanoseconds
+ */
+void alias_expansion_stats(unsigned long *count, unsigned long *ns)
+{
+	*count = alias_expansions;
+	*ns = alias_expand_ns;
+}
+
+/**
+ * print_alias_entry - prints one alias as name='value'
+ * @alias: alias to print
+ */
+void print_alias_entry(alias_t *alias)
+{
+	buffer_write(alias->name, interned_length(alias->name));
+	buffer_write("='", 2);
+	buffer_write(alias->value, interned_length(alias->value));
+	buffer_write("'\n", 2);
+}
+
+/**
+ * print_aliases - prints all aliases, in the order they were defined
+ */
+void print_aliases(void)
+{
+	size_t i;
+
+	for (i = 0; i < alias_count; i++)
+		print_alias_entry(&alias_entries[i]);
+}
+
+/**
+ * print_alias - prints aliases by name
+ * @alias_names: array of alias names
+ * @count: number of alias names
+ */
+void print_alias(char **alias_names, int count)
+{
+	alias_t *alias;
+	int i;
+
+	for (i = 0; i < count; i++)
+	{
+		alias = find_alias(alias_names[i]);
+		if (alias != NULL)
+			print_alias_entry(alias);
+	}
+}
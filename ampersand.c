@@ -4,6 +4,7 @@
 #include <unistd.h>
 #include <sys/wait.h>
 #include <sys/types.h>
+#include "main.h"
 
 #define MAX_INPUT_LENGTH 1024
 
@@ -12,7 +13,8 @@
  */
 void print_prompt(void)
 {
-	write(STDOUT_FILENO, "$ ", 2);
+	if (is_interactive())
+		write(STDOUT_FILENO, "$ ", 2);
 }
 
 /**
@@ -22,64 +24,42 @@ void print_prompt(void)
  */
 ssize_t read_input(char *input)
 {
-	ssize_t read_size = read(STDIN_FILENO, input, MAX_INPUT_LENGTH);
-
-	if (read_size == -1)
-	{
-		perror("read");
-		exit(EXIT_FAILURE);
-	}
-	else if (read_size == 0)
-	{
-		write(STDOUT_FILENO, "\n", 1);
-		exit(EXIT_SUCCESS);
-	}
-	/* Remove newline character from end of command */
-	input[read_size - 1] = '\0';
+	ssize_t read_size = read_line(input, MAX_INPUT_LENGTH);
 	return read_size;
 }
 
 /**
- * execute_command - executes command
+ * run_command - executes a one-word command
  * @command: command to execute
- * Return: status of the command execution
+ * Return: wait status of the command, 127 << 8 if it was not found
  */
-int execute_command(char *command)
+int run_command(char *command)
 {
-	pid_t pid = fork();
-	int status;
+	char *args[] = {command, NULL};
+	pid_t pid;
+	int status = 127 << 8;
+
+	if (access(command, F_OK) == -1)
+	{
+		write(STDERR_FILENO, "Command not found\n", 18);
+		return (status);
+	}
 
+	pid = spawn_command(args, NULL, -1, -1);
 	if (pid == -1)
 	{
 		perror("fork");
 		exit(EXIT_FAILURE);
 	}
-	else if (pid == 0)
+	else if (pid > 0)
 	{
-		/* Child process */
-		/* Execute command */
-		if (access(command, F_OK) != -1)
-		{
-			execve(command, NULL, environ);
-			perror("execve");
-			_exit(EXIT_FAILURE);
-		}
-		else
-		{
-			write(STDERR_FILENO, "Command not found\n", 18);
-			_exit(EXIT_FAILURE);
-		}
-	}
-	else
-	{
-		/* Parent process */
 		/* Wait for child process to complete */
-		do {
-			waitpid(pid, &status, WUNTRACED);
-		} while (!WIFEXITED(status) && !WIFSIGNALED(status));
+		wait_for_child(pid, &status);
 	}
+	else
+		status = 126 << 8;
 
-	return status;
+	return (status);
 }
 
 /**
@@ -92,8 +72,7 @@ int execute_command(char *command)
 int main(int argc, char **argv)
 {
 	char input[MAX_INPUT_LENGTH];
-	char **environ;
-	int status;
+	int status = 0;
 
 	while (1)
 	{
@@ -124,7 +103,7 @@ int main(int argc, char **argv)
 			else
 			{
 				// Execute the command
-				status = execute_command(token);
+				status = run_command(token);
 				token = strtok(NULL, " ");
 			}
 		}
@@ -0,0 +1,108 @@
+#include <stddef.h>
+#include "main.h"
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+#define ARENA_ALIGN (sizeof(max_align_t))
+
+/**
+ * struct arena_block - one chunk of memory handed out by the arena
+ * @next: next block in the chain
+ * @size: usable bytes in @data
+ * @used: bytes already handed out
+ * @data: the memory itself
+ */
+typedef struct arena_block
+{
+	struct arena_block *next;
+	size_t size;
+	size_t used;
+	max_align_t data[];
+} arena_block_t;
+
+static arena_block_t *arena_head;
+static arena_block_t *arena_current;
+
+/**
+ * arena_new_block - allocates a block large enough for a request
+ * @size: bytes that must fit in the block
+ * Return: the new block
+ */
+static arena_block_t *arena_new_block(size_t size)
+{
+	arena_block_t *block;
+
+	if (size < ARENA_BLOCK_SIZE)
+		size = ARENA_BLOCK_SIZE;
+
+	block = malloc(sizeof(*block) + size);
+	if (block == NULL)
+	{
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+	block->next = NULL;
+	block->size = size;
+	block->used = 0;
+	return (block);
+}
+
+/**
+ * arena_alloc - allocates memory that lives until the next arena_reset
+ * @size: number of bytes
+ * Return: pointer to the memory
+ */
+void *arena_alloc(size_t size)
+{
+	arena_block_t *block;
+
+	size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+	if (arena_current == NULL)
+		arena_head = arena_current = arena_new_block(size);
+
+	/* Reuse the blocks kept from earlier command lines first */
+	while (arena_current->size - arena_current->used < size)
+	{
+		if (arena_current->next == NULL ||
+		    arena_current->next->size < size)
+		{
+			block = arena_new_block(size);
+			block->next = arena_current->next;
+			arena_current->next = block;
+		}
+		arena_current = arena_current->next;
+		arena_current->used = 0;
+	}
+
+	block = arena_current;
+	block->used += size;
+	return ((char *)block->data + block->used - size);
+}
+
+/**
+ * arena_strndup - copies a string into the arena
+ * @str: string to copy
+ * @len: number of bytes to copy
+ * Return: NUL-terminated copy
+ */
+char *arena_strndup(const char *str, size_t len)
+{
+	char *copy = arena_alloc(len + 1);
+
+	memcpy(copy, str, len);
+	copy[len] = '\0';
+	return (copy);
+}
+
+/**
+ * arena_reset - releases everything allocated for the last command line
+ *
+ * The blocks themselves are kept, so the next command line allocates
+ * without calling malloc.
+ */
+void arena_reset(void)
+{
+	arena_current = arena_head;
+	if (arena_current != NULL)
+		arena_current->used = 0;
+}
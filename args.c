@@ -12,63 +12,40 @@ extern char **environ;
 
 void print_prompt(void)
 {
-	write(STDOUT_FILENO, "$ ", 2);
+	if (is_interactive())
+		write(STDOUT_FILENO, "$ ", 2);
 }
 
 ssize_t read_command(char *input)
 {
-	ssize_t read_size = read(STDIN_FILENO, input, MAX_INPUT_LENGTH);
-
-	if (read_size == -1)
-	{
-		perror("read");
-		exit(EXIT_FAILURE);
-	}
-	else if (read_size == 0)
-	{
-		write(STDOUT_FILENO, "\n", 1);
-		exit(EXIT_SUCCESS);
-	}
-
-	/* Remove newline character from end of command */
-	input[read_size - 1] = '\0';
+	ssize_t read_size = read_line(input, MAX_INPUT_LENGTH);
 
 	return (read_size);
 }
 
-void parse_command(char *input, char **args)
+char **parse_command(char *input)
 {
+	size_t size = MAX_NUM_ARGS, i = 0;
+	char **args = arena_alloc(size * sizeof(*args));
+	char **grown;
 	char *arg = strtok(input, " ");
-	int i = 0;
 
-	while (arg != NULL && i < MAX_INPUT_LENGTH - 1)
+	while (arg != NULL)
 	{
+		/* Grow the argument vector instead of truncating the command */
+		if (i == size - 1)
+		{
+			grown = arena_alloc(2 * size * sizeof(*args));
+			memcpy(grown, args, i * sizeof(*args));
+			args = grown;
+			size *= 2;
+		}
 		args[i++] = arg;
 		arg = strtok(NULL, " ");
 	}
 	args[i] = NULL;
-}
 
-void execute_command(char **args)
-{
-	if (access(args[0], F_OK) != -1)
-	{
-		execve(args[0], args, environ);
-		perror("execve");
-		_exit(EXIT_FAILURE);
-	}
-	else
-	{
-		write(STDERR_FILENO, "Command not found\n", 18);
-		_exit(EXIT_FAILURE);
-	}
-}
-
-void wait_for_child(pid_t pid, int *status)
-{
-	do {
-		waitpid(pid, status, WUNTRACED);
-	} while (!WIFEXITED(*status) && !WIFSIGNALED(*status));
+	return (args);
 }
 
 void handle_command_execution(char **args)
@@ -76,22 +53,21 @@ void handle_command_execution(char **args)
 	pid_t pid;
 	int status;
 
+	if (access(args[0], F_OK) == -1)
+	{
+		write(STDERR_FILENO, "Command not found\n", 18);
+		return;
+	}
+
 	/* Create child process */
-	pid = fork();
+	pid = spawn_command(args, NULL, -1, -1);
 
 	if (pid == -1)
 	{
 		perror("fork");
 		exit(EXIT_FAILURE);
 	}
-	else if (pid == 0)
-	{
-		/* Child process */
-
-		/* Execute command */
-		execute_command(args);
-	}
-	else
+	else if (pid > 0)
 	{
 		/* Parent process */
 
@@ -103,10 +79,13 @@ void handle_command_execution(char **args)
 int main(int argc, char **argv)
 {
 	char input[MAX_INPUT_LENGTH];
-	char *args[MAX_INPUT_LENGTH];
+	char **args;
 
 	while (1)
 	{
+		/* Release the previous command line */
+		arena_reset();
+
 		/* Print prompt */
 		print_prompt();
 
@@ -114,7 +93,7 @@ int main(int argc, char **argv)
 		ssize_t read_size = read_command(input);
 
 		/* Parse command into arguments */
-		parse_command(input, args);
+		args = parse_command(input);
 
 		/* Handle command execution */
 		handle_command_execution(args);
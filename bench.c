@@ -0,0 +1,534 @@
+/*
+ * Microbenchmarks of the per-command routines
+ *
+ * Build and run from the repository root:
+ *   make bench
+ *   ./bench [milliseconds per measure]
+ *
+ * The routines are linked from the same objects the programs use.
+ * Every measure reports ns/op and the malloc, calloc, realloc, strdup
+ * and strndup calls made per op, counted by the __wrap_ hooks below:
+ * the Makefile links bench with -Wl,--wrap for each of them. The
+ * launch of a command is measured with each spawn backend while the
+ * shell's resident set grows, and summed up as commands per second.
+ * The line readers are also fed a gigabyte through a pipe, as a piped
+ * script would be.
+ */
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include "main.h"
+
+#define BENCH_LINES 4096
+#define BENCH_LINE_MAX 8192
+/* Room for the largest command line, 100000 words */
+#define BENCH_COMMAND_MAX (2 * 1024 * 1024)
+#define BENCH_BACKENDS 4
+#define BENCH_PIPE_BYTES (1024L * 1024 * 1024)
+#define BENCH_PIPE_BLOCK (64 * 1024)
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+char *__real_strdup(const char *str);
+char *__real_strndup(const char *str, size_t len);
+
+static unsigned long bench_allocs;
+static volatile long bench_sink;
+static long long bench_min_ns = 200000000LL;
+
+static char bench_template[BENCH_COMMAND_MAX];
+static size_t bench_template_len;
+static char bench_line[BENCH_COMMAND_MAX];
+static char *bench_names[4096];
+static int bench_name_count;
+static int bench_lines_left;
+static char *getline_buffer;
+static size_t getline_size;
+static char *bench_spawn_args[] = {"/bin/true", NULL};
+static const char *const bench_backends[BENCH_BACKENDS] = {
+	"fork", "vfork", "clone", "posix_spawn"
+};
+
+/**
+ * __wrap_malloc - counts an allocation made by the linked objects
+ * @size: number of bytes
+ * Return: the memory
+ */
+void *__wrap_malloc(size_t size)
+{
+	bench_allocs++;
+	return (__real_malloc(size));
+}
+
+/**
+ * __wrap_calloc - counts an allocation made by the linked objects
+ * @count: number of elements
+ * @size: size of an element
+ * Return: the zeroed memory
+ */
+void *__wrap_calloc(size_t count, size_t size)
+{
+	bench_allocs++;
+	return (__real_calloc(count, size));
+}
+
+/**
+ * __wrap_realloc - counts an allocation made by the linked objects
+ * @ptr: memory to resize
+ * @size: new size
+ * Return: the memory
+ */
+void *__wrap_realloc(void *ptr, size_t size)
+{
+	bench_allocs++;
+	return (__real_realloc(ptr, size));
+}
+
+/**
+ * __wrap_strdup - counts a copy made by the linked objects
+ * @str: string to copy
+ * Return: the copy
+ */
+char *__wrap_strdup(const char *str)
+{
+	bench_allocs++;
+	return (__real_strdup(str));
+}
+
+/**
+ * __wrap_strndup - counts a copy made by the linked objects
+ * @str: string to copy
+ * @len: largest number of bytes to copy
+ * Return: the copy
+ */
+char *__wrap_strndup(const char *str, size_t len)
+{
+	bench_allocs++;
+	return (__real_strndup(str, len));
+}
+
+/**
+ * bench_run - measures one operation
+ * @name: name of the benchmark
+ * @size: size of its input, as described by @unit
+ * @unit: what @size counts
+ * @op: operation to run
+ *
+ * The iteration count is doubled until a run takes at least the
+ * measuring time; the last run is the one reported.
+ * Return: time of one operation, in ns
+ */
+static double bench_run(const char *name, long size, const char *unit,
+		      void (*op)(void))
+{
+	unsigned long iterations = 1, i, allocs;
+	long long elapsed;
+
+	while (1)
+	{
+		allocs = bench_allocs;
+		elapsed = monotonic_ns();
+		for (i = 0; i < iterations; i++)
+			op();
+		elapsed = monotonic_ns() - elapsed;
+		allocs = bench_allocs - allocs;
+		if (elapsed >= bench_min_ns || iterations >= (1UL << 40))
+			break;
+		iterations *= 2;
+	}
+
+	printf("%-28s %6ld %-8s %12.1f ns/op %10.3f allocs/op\n", name, size,
+	       unit, (double)elapsed / iterations, (double)allocs / iterations);
+	fflush(stdout);
+	return ((double)elapsed / iterations);
+}
+
+/**
+ * bench_words - builds a command line of a number of words
+ * @count: number of words
+ */
+static void bench_words(int count)
+{
+	size_t len = 0;
+	int i;
+
+	bench_template[0] = '\0';
+	for (i = 0; i < count; i++)
+		len += sprintf(bench_template + len, "%sword%d", i ? " " : "", i);
+	bench_template_len = len;
+}
+
+/**
+ * bench_stdin - makes standard input a file of identical lines
+ * @length: length of every line, without its newline
+ */
+static void bench_stdin(size_t length)
+{
+	char path[] = "/tmp/bench-XXXXXX";
+	int fd = mkstemp(path), i;
+
+	memset(bench_line, 'x', length);
+	bench_line[length] = '\n';
+	for (i = 0; i < BENCH_LINES; i++)
+		write(fd, bench_line, length + 1);
+	unlink(path);
+	dup2(fd, STDIN_FILENO);
+	close(fd);
+	lseek(STDIN_FILENO, 0, SEEK_SET);
+	bench_lines_left = BENCH_LINES;
+}
+
+/**
+ * bench_rewind - starts standard input over once every line is read
+ *
+ * The readers never see the end of the file, at which read_line
+ * would exit.
+ */
+static void bench_rewind(void)
+{
+	if (bench_lines_left-- == 0)
+	{
+		lseek(STDIN_FILENO, 0, SEEK_SET);
+		bench_lines_left = BENCH_LINES - 1;
+	}
+}
+
+/**
+ * bench_pipe_writer - writes the lines of a piped input, then exits
+ * @fd: write end of the pipe
+ * @length: length of every line, without its newline
+ * @lines: number of lines to write
+ */
+static void bench_pipe_writer(int fd, size_t length, long lines)
+{
+	static char block[BENCH_PIPE_BLOCK];
+	long per_block = sizeof(block) / (length + 1), count;
+	size_t size, done;
+	ssize_t written;
+	long i;
+
+	for (i = 0; i < per_block; i++)
+	{
+		memset(block + i * (length + 1), 'x', length);
+		block[i * (length + 1) + length] = '\n';
+	}
+	for (; lines > 0; lines -= count)
+	{
+		count = lines < per_block ? lines : per_block;
+		size = count * (length + 1);
+		for (done = 0; done < size; done += written)
+		{
+			written = write(fd, block + done, size - done);
+			if (written <= 0)
+				_exit(1);
+		}
+	}
+	_exit(0);
+}
+
+/**
+ * bench_pipe - measures the throughput of a line reader on piped input
+ * @name: name of the reader
+ * @length: length of every line, without its newline
+ * @op: operation reading one line from standard input
+ *
+ * A child writes BENCH_PIPE_BYTES worth of lines into a pipe that is
+ * standard input meanwhile, and the reader is timed until it has read
+ * every one of them.
+ */
+static void bench_pipe(const char *name, size_t length, void (*op)(void))
+{
+	long lines = BENCH_PIPE_BYTES / (length + 1), i;
+	long long elapsed;
+	int fds[2], saved, status;
+	pid_t pid;
+
+	if (pipe(fds) == -1)
+		return;
+	pid = fork();
+	if (pid == 0)
+	{
+		close(fds[0]);
+		bench_pipe_writer(fds[1], length, lines);
+	}
+	close(fds[1]);
+	saved = dup(STDIN_FILENO);
+	dup2(fds[0], STDIN_FILENO);
+	close(fds[0]);
+
+	/* The pipe is never rewound */
+	bench_lines_left = lines;
+	elapsed = monotonic_ns();
+	for (i = 0; i < lines; i++)
+		op();
+	elapsed = monotonic_ns() - elapsed;
+
+	dup2(saved, STDIN_FILENO);
+	close(saved);
+	if (pid > 0)
+		waitpid(pid, &status, 0);
+	printf("%-28s %6ld %-8s %12.1f MiB/s %9.1f ns/line\n", name,
+	       (long)length, "bytes", (double)lines * (length + 1) / (1 << 20)
+	       / (elapsed / 1e9), (double)elapsed / lines);
+	fflush(stdout);
+}
+
+/**
+ * op_strtok_words - splits a line with strtok_words
+ */
+static void op_strtok_words(void)
+{
+	memcpy(bench_line, bench_template, bench_template_len + 1);
+	bench_sink = (long)strtok_words(bench_line);
+	arena_reset();
+}
+
+/**
+ * op_split_words - splits a line with split_words
+ */
+static void op_split_words(void)
+{
+	memcpy(bench_line, bench_template, bench_template_len + 1);
+	bench_sink = (long)split_words(bench_line);
+	arena_reset();
+}
+
+/**
+ * op_count_args - counts the words of a line
+ */
+static void op_count_args(void)
+{
+	bench_sink = count_args(bench_template);
+}
+
+/**
+ * op_custom_getline - reads one line with custom_getline
+ */
+static void op_custom_getline(void)
+{
+	bench_rewind();
+	bench_sink = custom_getline(&getline_buffer, &getline_size);
+}
+
+/**
+ * op_read_line - reads one line with read_line
+ */
+static void op_read_line(void)
+{
+	bench_rewind();
+	bench_sink = read_line(bench_line, MAX_INPUT_LENGTH);
+}
+
+/**
+ * op_find_alias - looks up a defined alias and a missing name
+ */
+static void op_find_alias(void)
+{
+	static int next;
+
+	bench_sink = (long)find_alias(bench_names[next]);
+	bench_sink = (long)find_alias("no-such-alias");
+	next = (next + 1) % bench_name_count;
+}
+
+/**
+ * op_print_environment - prints the environment into /dev/null
+ */
+static void op_print_environment(void)
+{
+	print_environment();
+	buffer_flush();
+}
+
+/**
+ * op_find_command - resolves a command already in the hash table
+ */
+static void op_find_command(void)
+{
+	bench_sink = (long)find_command("ls");
+}
+
+/**
+ * op_find_command_cold - resolves a command after the table is reset
+ */
+static void op_find_command_cold(void)
+{
+	hash_reset();
+	bench_sink = (long)find_command("ls");
+}
+
+/**
+ * op_spawn - launches /bin/true and waits for it
+ */
+static void op_spawn(void)
+{
+	int status;
+
+	wait_for_child(spawn_command(bench_spawn_args, NULL, -1, -1), &status);
+}
+
+/**
+ * bench_spawn - measures the launch of a command with one backend
+ * @backend: backend, as named in SHELL_SPAWN
+ * @rss: memory the shell touches beforehand, in MiB
+ *
+ * Each measure runs in a child of its own, so the backend is picked
+ * afresh and the memory is handed back when it exits.
+ * Return: commands per second, 0 if the measure failed
+ */
+static double bench_spawn(const char *backend, int rss)
+{
+	size_t size = (size_t)rss << 20;
+	double ns = 0;
+	char name[32], *ballast;
+	int fds[2], status;
+	pid_t pid;
+
+	if (pipe2(fds, O_CLOEXEC) == -1)
+		return (0);
+	pid = fork();
+	if (pid == 0)
+	{
+		env_set("SHELL_SPAWN", backend, 1);
+		ballast = malloc(size);
+		if (ballast != NULL)
+			memset(ballast, 1, size);
+		snprintf(name, sizeof(name), "spawn (%s)", backend);
+		ns = bench_run(name, rss, "MiB rss", op_spawn);
+		write(fds[1], &ns, sizeof(ns));
+		_exit(0);
+	}
+	close(fds[1]);
+	if (pid > 0)
+	{
+		if (read(fds[0], &ns, sizeof(ns)) != sizeof(ns))
+			ns = 0;
+		waitpid(pid, &status, 0);
+	}
+	close(fds[0]);
+	return (ns > 0 ? 1e9 / ns : 0);
+}
+
+/**
+ * bench_aliases - defines aliases until there are a number of them
+ * @count: number of aliases wanted
+ */
+static void bench_aliases(int count)
+{
+	char name[32];
+
+	for (; bench_name_count < count; bench_name_count++)
+	{
+		sprintf(name, "alias%d", bench_name_count);
+		bench_names[bench_name_count] = strdup(name);
+		add_alias(bench_names[bench_name_count], "ls -l --color=auto");
+	}
+}
+
+/**
+ * bench_path - sets PATH to directories that miss before /usr/bin
+ * @misses: number of directories searched in vain
+ */
+static void bench_path(int misses)
+{
+	char path[BENCH_LINE_MAX];
+	size_t len = 0;
+	int i;
+
+	for (i = 0; i < misses; i++)
+		len += sprintf(path + len, "/nonexistent/bin%d:", i);
+	strcpy(path + len, "/usr/bin:/bin");
+	env_set("PATH", path, 1);
+}
+
+/**
+ * main - runs every benchmark
+ * @argc: argument count
+ * @argv: argument vector, optionally the time of a measure in ms
+ * Return: 0
+ */
+int main(int argc, char **argv)
+{
+	static const int words[] = {1, 8, 64, 512, 100000};
+	static const int lengths[] = {16, 256, 1000};
+	static const int aliases[] = {16, 256, 4096};
+	static const int variables[] = {0, 100, 1000};
+	static const int misses[] = {0, 8, 32};
+	static const int rss[] = {0, 16, 128, 1024};
+	double rates[BENCH_BACKENDS][sizeof(rss) / sizeof(*rss)];
+	char name[32];
+	size_t i;
+	int j, null;
+
+	if (argc > 1 && atoi(argv[1]) > 0)
+		bench_min_ns = atoi(argv[1]) * 1000000LL;
+
+	for (i = 0; i < sizeof(words) / sizeof(*words); i++)
+	{
+		bench_words(words[i]);
+		bench_run("strtok_words", words[i], "words", op_strtok_words);
+		bench_run("split_words", words[i], "words", op_split_words);
+		bench_run("count_args", words[i], "words", op_count_args);
+	}
+
+	for (i = 0; i < sizeof(lengths) / sizeof(*lengths); i++)
+	{
+		bench_stdin(lengths[i]);
+		bench_run("custom_getline", lengths[i], "bytes", op_custom_getline);
+		bench_stdin(lengths[i]);
+		bench_run("read_line", lengths[i], "bytes", op_read_line);
+	}
+	for (i = 0; i < sizeof(lengths) / sizeof(*lengths); i++)
+	{
+		bench_pipe("custom_getline (1 GiB pipe)", lengths[i],
+			   op_custom_getline);
+		bench_pipe("read_line (1 GiB pipe)", lengths[i], op_read_line);
+	}
+
+	for (i = 0; i < sizeof(aliases) / sizeof(*aliases); i++)
+	{
+		bench_aliases(aliases[i]);
+		bench_run("find_alias (hit + miss)", aliases[i], "aliases",
+			  op_find_alias);
+	}
+
+	null = open("/dev/null", O_WRONLY | O_CLOEXEC);
+	buffer_set_fd(null);
+	for (i = 0, j = 0; i < sizeof(variables) / sizeof(*variables); i++)
+	{
+		for (; j < variables[i]; j++)
+		{
+			sprintf(name, "BENCH_VARIABLE_%d", j);
+			env_set(name, "some value of the variable", 1);
+		}
+		bench_run("print_environment", variables[i], "extra",
+			  op_print_environment);
+	}
+	buffer_set_fd(STDOUT_FILENO);
+
+	for (i = 0; i < sizeof(misses) / sizeof(*misses); i++)
+	{
+		bench_path(misses[i]);
+		bench_run("find_command (hashed)", misses[i], "misses",
+			  op_find_command);
+		bench_run("find_command (cold)", misses[i], "misses",
+			  op_find_command_cold);
+	}
+
+	for (i = 0; i < sizeof(rss) / sizeof(*rss); i++)
+	{
+		for (j = 0; j < BENCH_BACKENDS; j++)
+			rates[j][i] = bench_spawn(bench_backends[j], rss[i]);
+	}
+	printf("\n%-28s", "commands/s by shell RSS");
+	for (i = 0; i < sizeof(rss) / sizeof(*rss); i++)
+		printf(" %6d MiB", rss[i]);
+	for (j = 0; j < BENCH_BACKENDS; j++)
+	{
+		printf("\n%-28s", bench_backends[j]);
+		for (i = 0; i < sizeof(rss) / sizeof(*rss); i++)
+			printf(" %10.0f", rates[j][i]);
+	}
+	printf("\n");
+	return (0);
+}
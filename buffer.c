@@ -0,0 +1,244 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include "main.h"
+
+#define OUTPUT_BUFFER_SIZE 8192
+#define SPLICE_CHUNK_SIZE (64 * 1024)
+
+static char output_buffer[OUTPUT_BUFFER_SIZE];
+static size_t output_used;
+static int output_registered;
+static int output_fd = STDOUT_FILENO;
+static int output_splice;
+static char *splice_data;
+static size_t splice_used;
+
+/**
+ * write_vector - writes every byte described by an iovec array
+ * @iov: data to write, modified as it is consumed
+ * @count: number of entries in @iov
+ * Return: 0 on success, -1 on error
+ */
+static int write_vector(struct iovec *iov, int count)
+{
+	ssize_t written;
+
+	while (count > 0)
+	{
+		written = writev(output_fd, iov, count);
+		if (written == -1)
+		{
+			if (errno == EINTR)
+				continue;
+			return (-1);
+		}
+
+		while (count > 0 && (size_t)written >= iov->iov_len)
+		{
+			written -= iov->iov_len;
+			iov++;
+			count--;
+		}
+		if (count > 0)
+		{
+			iov->iov_base = (char *)iov->iov_base + written;
+			iov->iov_len -= written;
+		}
+	}
+	return (0);
+}
+
+/**
+ * splice_flush - gifts the collected chunk to a pipe with vmsplice
+ *
+ * The pipe takes the pages instead of copying them, so they are never
+ * written to again: the chunk is unmapped, which leaves the pipe's
+ * references alone, and the next output goes to a fresh one.
+ */
+static void splice_flush(void)
+{
+	struct iovec iov[1];
+	ssize_t spliced;
+
+	iov[0].iov_base = splice_data;
+	iov[0].iov_len = splice_used;
+	while (iov[0].iov_len > 0)
+	{
+		spliced = vmsplice(output_fd, iov, 1, SPLICE_F_GIFT);
+		if (spliced == -1)
+		{
+			if (errno == EINTR)
+				continue;
+			/* Not a pipe after all */
+			if (write_vector(iov, 1) == -1)
+				perror("write");
+			break;
+		}
+		iov[0].iov_base = (char *)iov[0].iov_base + spliced;
+		iov[0].iov_len -= spliced;
+	}
+
+	munmap(splice_data, SPLICE_CHUNK_SIZE);
+	splice_data = NULL;
+	splice_used = 0;
+}
+
+/**
+ * buffer_use_vmsplice - sends all later output to a pipe with vmsplice
+ *
+ * Output is collected in page-aligned chunks of SPLICE_CHUNK_SIZE
+ * bytes that are gifted to the pipe when full or flushed, and never
+ * reused, so this is only meant for a child that exits after writing
+ * into a pipeline.
+ */
+void buffer_use_vmsplice(void)
+{
+	output_splice = 1;
+}
+
+/**
+ * buffer_flush - writes out everything buffered for stdout
+ *
+ * Called at command boundaries and before a child is started, so
+ * builtin output stays ordered with the output of other commands.
+ */
+void buffer_flush(void)
+{
+	struct iovec iov[1];
+
+	if (splice_used > 0)
+		splice_flush();
+	if (output_used == 0)
+		return;
+
+	iov[0].iov_base = output_buffer;
+	iov[0].iov_len = output_used;
+	output_used = 0;
+	if (write_vector(iov, 1) == -1)
+		perror("write");
+}
+
+/**
+ * buffer_set_fd - changes the descriptor the buffer is written to
+ * @fd: new descriptor
+ *
+ * Pending output is flushed to the old descriptor first.
+ * Return: the previous descriptor
+ */
+int buffer_set_fd(int fd)
+{
+	int previous = output_fd;
+
+	buffer_flush();
+	output_fd = fd;
+	return (previous);
+}
+
+/**
+ * splice_append - collects output that will be spliced into a pipe
+ * @data: bytes to write
+ * @len: number of bytes
+ *
+ * At most one chunk is held at a time; a full one is spliced before
+ * more is collected.
+ */
+static void splice_append(const char *data, size_t len)
+{
+	size_t part;
+
+	while (len > 0)
+	{
+		if (splice_data == NULL)
+		{
+			splice_data = mmap(NULL, SPLICE_CHUNK_SIZE,
+					   PROT_READ | PROT_WRITE,
+					   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (splice_data == MAP_FAILED)
+			{
+				perror("mmap");
+				exit(EXIT_FAILURE);
+			}
+		}
+		part = SPLICE_CHUNK_SIZE - splice_used;
+		if (part > len)
+			part = len;
+		memcpy(splice_data + splice_used, data, part);
+		splice_used += part;
+		data += part;
+		len -= part;
+		if (splice_used == SPLICE_CHUNK_SIZE)
+			splice_flush();
+	}
+}
+
+/**
+ * buffer_write - appends data to the stdout buffer
+ * @data: bytes to write
+ * @len: number of bytes
+ *
+ * Data that does not fit is written together with the buffered bytes
+ * in a single writev, without being copied first.
+ */
+void buffer_write(const char *data, size_t len)
+{
+	struct iovec iov[2];
+
+	if (!output_registered)
+	{
+		atexit(buffer_flush);
+		output_registered = 1;
+	}
+
+	if (output_splice)
+	{
+		splice_append(data, len);
+		return;
+	}
+
+	if (len <= OUTPUT_BUFFER_SIZE - output_used)
+	{
+		memcpy(output_buffer + output_used, data, len);
+		output_used += len;
+		return;
+	}
+
+	iov[0].iov_base = output_buffer;
+	iov[0].iov_len = output_used;
+	iov[1].iov_base = (char *)data;
+	iov[1].iov_len = len;
+	output_used = 0;
+	if (write_vector(iov, 2) == -1)
+		perror("write");
+}
+
+/**
+ * buffer_puts - appends a string to the stdout buffer
+ * @str: string to write
+ */
+void buffer_puts(const char *str)
+{
+	buffer_write(str, strlen(str));
+}
+
+/**
+ * buffer_put_number - appends a decimal number to the stdout buffer
+ * @n: number to write
+ */
+void buffer_put_number(long n)
+{
+	char digits[24];
+	int i = sizeof(digits);
+	unsigned long value = n < 0 ? -(unsigned long)n : (unsigned long)n;
+
+	do {
+		digits[--i] = '0' + value % 10;
+		value /= 10;
+	} while (value != 0);
+
+	if (n < 0)
+		digits[--i] = '-';
+	buffer_write(digits + i, sizeof(digits) - i);
+}
@@ -0,0 +1,268 @@
+#include <errno.h>
+#include "main.h"
+
+#define BUILTIN_SLOTS 32
+
+/*
+ * BUILTIN_SLOT - perfect hash of a builtin name
+ *
+ * Only the first character, the last character and the length are
+ * hashed, so a name is placed with a constant expression. Two builtins
+ * landing in the same slot override each other in the table below,
+ * which the compiler reports (-Woverride-init, part of -Wextra).
+ */
+#define BUILTIN_SLOT(first, last, len) \
+	(((first) * 4 + (last) * 10 + (len)) % BUILTIN_SLOTS)
+
+static int builtin_exit(int argc, char **argv, builtin_io_t *io);
+static int builtin_env(int argc, char **argv, builtin_io_t *io);
+static int builtin_setenv(int argc, char **argv, builtin_io_t *io);
+static int builtin_unsetenv(int argc, char **argv, builtin_io_t *io);
+static int builtin_alias(int argc, char **argv, builtin_io_t *io);
+static int builtin_set(int argc, char **argv, builtin_io_t *io);
+
+static const builtin_t builtins[BUILTIN_SLOTS] = {
+	[BUILTIN_SLOT('e', 't', 4)] = {"exit", builtin_exit},
+	[BUILTIN_SLOT('e', 'v', 3)] = {"env", builtin_env},
+	[BUILTIN_SLOT('s', 'v', 6)] = {"setenv", builtin_setenv},
+	[BUILTIN_SLOT('u', 'v', 8)] = {"unsetenv", builtin_unsetenv},
+	[BUILTIN_SLOT('c', 'd', 2)] = {"cd", cd_builtin},
+	[BUILTIN_SLOT('p', 'd', 5)] = {"pushd", pushd_builtin},
+	[BUILTIN_SLOT('p', 'd', 4)] = {"popd", popd_builtin},
+	[BUILTIN_SLOT('d', 's', 4)] = {"dirs", dirs_builtin},
+	[BUILTIN_SLOT('j', 's', 4)] = {"jobs", jobs_builtin},
+	[BUILTIN_SLOT('w', 't', 4)] = {"wait", wait_builtin},
+	[BUILTIN_SLOT('a', 's', 5)] = {"alias", builtin_alias},
+	[BUILTIN_SLOT('h', 'h', 4)] = {"hash", hash_builtin},
+	[BUILTIN_SLOT('t', 't', 7)] = {"timeout", timeout_builtin},
+	[BUILTIN_SLOT('s', 't', 9)] = {"shellstat", shellstat_builtin},
+	[BUILTIN_SLOT('s', 't', 3)] = {"set", builtin_set},
+};
+
+/**
+ * find_builtin - looks up a builtin by name
+ * @name: command name
+ *
+ * The name is hashed to its only possible slot, so recognising a
+ * builtin, or rejecting a command that is not one, is a single probe.
+ * Return: the builtin, NULL if @name is not a builtin
+ */
+const builtin_t *find_builtin(const char *name)
+{
+	size_t len = strlen(name);
+	const builtin_t *builtin;
+
+	if (len == 0)
+		return (NULL);
+
+	builtin = &builtins[BUILTIN_SLOT((unsigned char)name[0],
+					 (unsigned char)name[len - 1], len)];
+	if (builtin->name == NULL || strcmp(builtin->name, name) != 0)
+		return (NULL);
+	return (builtin);
+}
+
+/**
+ * run_builtin - runs a builtin in the shell process
+ * @builtin: builtin returned by find_builtin
+ * @args: command arguments
+ * @io: descriptors to use, NULL for the shell's own
+ * Return: exit status of the builtin
+ */
+int run_builtin(const builtin_t *builtin, char **args, builtin_io_t *io)
+{
+	builtin_io_t standard = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+	int argc, status, previous;
+	long long start = STAT_START();
+
+	if (io == NULL)
+		io = &standard;
+	for (argc = 0; args[argc] != NULL; argc++)
+		;
+
+	previous = buffer_set_fd(io->out);
+	status = builtin->handler(argc, args, io);
+	buffer_set_fd(previous);
+	STAT_COUNT(STAT_BUILTINS);
+	STAT_RECORD(STAT_BUILTIN, start);
+	return (status);
+}
+
+/**
+ * print_environment - prints the exported variables
+ */
+void print_environment(void)
+{
+	char **env = env_environ();
+
+	while (*env != NULL)
+	{
+		buffer_puts(*env);
+		buffer_write("\n", 1);
+
+		env++;
+	}
+}
+
+/**
+ * builtin_exit - implements the exit builtin
+ * @argc: number of arguments
+ * @argv: command arguments
+ * @io: descriptors of the builtin
+ * Return: 2 on bad usage; does not return otherwise
+ */
+static int builtin_exit(int argc, char **argv, builtin_io_t *io)
+{
+	char *end;
+	long status = EXIT_SUCCESS;
+
+	if (argc > 1)
+	{
+		errno = 0;
+		status = strtol(argv[1], &end, 10);
+		if (errno != 0 || *end != '\0' || end == argv[1] || status < 0)
+		{
+			write(io->err, "exit: Illegal number\n", 21);
+			return (2);
+		}
+	}
+	buffer_flush();
+	exit(status & 0xff);
+}
+
+/**
+ * builtin_env - implements the env builtin
+ * @argc: number of arguments
+ * @argv: command arguments
+ * @io: descriptors of the builtin
+ * Return: always 0
+ */
+static int builtin_env(int argc, char **argv, builtin_io_t *io)
+{
+	(void)argc;
+	(void)argv;
+	(void)io;
+
+	print_environment();
+	return (0);
+}
+
+/**
+ * builtin_setenv - implements the setenv builtin
+ * @argc: number of arguments
+ * @argv: command arguments
+ * @io: descriptors of the builtin
+ * Return: 0 on success, 1 on failure
+ */
+static int builtin_setenv(int argc, char **argv, builtin_io_t *io)
+{
+	if (argc != 3)
+	{
+		write(io->err, "Usage: setenv VARIABLE VALUE\n", 29);
+		return (1);
+	}
+	if (env_set(argv[1], argv[2], 1) != 0)
+	{
+		perror("setenv");
+		return (1);
+	}
+	return (0);
+}
+
+/**
+ * builtin_unsetenv - implements the unsetenv builtin
+ * @argc: number of arguments
+ * @argv: command arguments
+ * @io: descriptors of the builtin
+ * Return: 0 on success, 1 on failure
+ */
+static int builtin_unsetenv(int argc, char **argv, builtin_io_t *io)
+{
+	if (argc != 2)
+	{
+		write(io->err, "Usage: unsetenv VARIABLE\n", 25);
+		return (1);
+	}
+	if (env_unset(argv[1]) != 0)
+	{
+		perror("unsetenv");
+		return (1);
+	}
+	return (0);
+}
+
+/**
+ * builtin_alias - implements the alias builtin
+ * @argc: number of arguments
+ * @argv: command arguments
+ * @io: descriptors of the builtin
+ *
+ * Without arguments every alias is printed; NAME=VALUE defines an
+ * alias and a bare NAME prints it.
+ * Return: 0 on success, 1 if a named alias does not exist
+ */
+static int builtin_alias(int argc, char **argv, builtin_io_t *io)
+{
+	alias_t *alias;
+	char *equal;
+	int i, status = 0;
+
+	if (argc == 1)
+	{
+		print_aliases();
+		return (0);
+	}
+
+	for (i = 1; i < argc; i++)
+	{
+		equal = strchr(argv[i], '=');
+		if (equal != NULL && equal != argv[i])
+		{
+			add_alias(arena_strndup(argv[i], equal - argv[i]), equal + 1);
+			continue;
+		}
+
+		alias = find_alias(argv[i]);
+		if (alias != NULL)
+		{
+			print_alias_entry(alias);
+			continue;
+		}
+		write(io->err, "alias: ", 7);
+		write(io->err, argv[i], strlen(argv[i]));
+		write(io->err, " not found\n", 11);
+		status = 1;
+	}
+	return (status);
+}
+
+/**
+ * builtin_set - implements the set builtin
+ * @argc: number of arguments
+ * @argv: command arguments
+ * @io: descriptors of the builtin
+ *
+ * set -o trace starts a Chrome trace of the commands that follow and
+ * set +o trace writes it out; set -o lists the options.
+ * Return: 0 on success, 1 on failure
+ */
+static int builtin_set(int argc, char **argv, builtin_io_t *io)
+{
+	if (argc == 2 && strcmp(argv[1], "-o") == 0)
+	{
+		buffer_puts(trace_enabled ? "trace\ton\n" : "trace\toff\n");
+		return (0);
+	}
+	if (argc == 3 && strcmp(argv[2], "trace") == 0)
+	{
+		if (strcmp(argv[1], "-o") == 0)
+			return (trace_start() == -1);
+		if (strcmp(argv[1], "+o") == 0)
+		{
+			trace_finish();
+			return (0);
+		}
+	}
+	write(io->err, "Usage: set [-o|+o] [trace]\n", 27);
+	return (1);
+}
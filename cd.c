@@ -7,13 +7,15 @@
 #include "main.h"
 
 #define MAX_INPUT_LENGTH 1024
+#define MAX_NUM_ARGS 128
 
 /**
  * print_prompt - prints shell prompt
  */
 void print_prompt(void)
 {
-	write(STDOUT_FILENO, "$ ", 2);
+	if (is_interactive())
+		write(STDOUT_FILENO, "$ ", 2);
 }
 
 /**
@@ -23,156 +25,66 @@ void print_prompt(void)
  */
 ssize_t read_input(char *input)
 {
-	ssize_t read_size = read(STDIN_FILENO, input, MAX_INPUT_LENGTH);
-
-	if (read_size == -1)
-	{
-		perror("read");
-		exit(EXIT_FAILURE);
-	}
-	else if (read_size == 0)
-	{
-		write(STDOUT_FILENO, "\n", 1);
-		exit(EXIT_SUCCESS);
-	}
-	/* Remove newline character from end of command */
-	input[read_size - 1] = '\0';
+	ssize_t read_size = read_line(input, MAX_INPUT_LENGTH);
 	return (read_size);
 }
 
 /**
- * execute_command - executes command
- * @command: command to execute
+ * parse_command - splits a command line into words
+ * @input: command line, modified in place
+ * Return: NULL-terminated argument vector, allocated in the arena
  */
-void execute_command(char *command)
+char **parse_command(char *input)
 {
-	pid_t pid = fork();
-	int status;
+	size_t size = MAX_NUM_ARGS, i = 0;
+	char **args = arena_alloc(size * sizeof(*args));
+	char **grown;
+	char *arg = strtok(input, " \t");
 
-	if (pid == -1)
+	while (arg != NULL)
 	{
-		perror("fork");
-		exit(EXIT_FAILURE);
-	}
-	else if (pid == 0)
-	{
-		/* Child process */
-		/* Execute command */
-		if (access(command, F_OK) != -1)
+		if (i == size - 1)
 		{
-			execve(command, NULL, environ);
-			perror("execve");
-			_exit(EXIT_FAILURE);
+			grown = arena_alloc(2 * size * sizeof(*args));
+			memcpy(grown, args, i * sizeof(*args));
+			args = grown;
+			size *= 2;
 		}
-		else
-		{
-			write(STDERR_FILENO, "Command not found\n", 18);
-			_exit(EXIT_FAILURE);
-		}
-	}
-	else
-	{
-		 /* Parent process */
-		 /* Wait for child process to complete */
-		do {
-			waitpid(pid, &status, WUNTRACED);
-		} while (!WIFEXITED(status) && !WIFSIGNALED(status));
+		args[i++] = arg;
+		arg = strtok(NULL, " \t");
 	}
+	args[i] = NULL;
+
+	return (args);
 }
 
 /**
- * change_directory - changes the current directory
- * @path: path of the directory to change to
- * @prev_dir: previous directory
- * Return: 0 on success, -1 on failure
+ * run_command - executes a one-word command
+ * @command: command to execute
  */
-int change_directory(const char *path, char *prev_dir)
+void run_command(char *command)
 {
-	char *home_dir;
-	char *new_dir;
-
-	if (path == NULL)
-	{
-		home_dir = getenv("HOME");
-		if (home_dir == NULL)
-		{
-			write(STDERR_FILENO, "cd: No home directory\n", 22);
-			return -1;
-		}
-		new_dir = home_dir;
-	}
-	else if (strcmp(path, "-") == 0)
-	{
-		if (prev_dir == NULL)
-		{
-			write(STDERR_FILENO, "cd: No previous directory\n", 26);
-			return -1;
-		}
-		new_dir = prev_dir;
-	}
-	else
-	{
-		new_dir = path;
-	}
-
-	if (chdir(new_dir) != 0)
-	{
-		perror("cd");
-		return -1;
-	}
+	char *args[] = {command, NULL};
+	pid_t pid;
+	int status;
 
-	char *cwd = getcwd(NULL, 0);
-	if (cwd == NULL)
-	{
-		perror("getcwd");
-		return -1;
-	}
-	if (setenv("PWD", cwd, 1) != 0)
+	if (access(command, F_OK) == -1)
 	{
-		perror("setenv");
-		free(cwd);
-		return -1;
+		write(STDERR_FILENO, "Command not found\n", 18);
+		return;
 	}
 
-	free(cwd);
-
-	return 0;
-}
-
-/**
- * handle_builtin_commands - handle builtin commands
- * @args: command arguments
- * @prev_dir: pointer to previous directory
- * Return: 1 if command is builtin, 0 otherwise
- */
-int handle_builtin_commands(char **args, char *prev_dir)
-{
-	if (strcmp(args[0], "cd") == 0)
-	{
-		if (args[1] != NULL)
-		{
-			if (change_directory(args[1], prev_dir) != 0)
-				return 0;
-		}
-		else
-		{
-			if (change_directory(NULL, prev_dir) != 0)
-				return 0;
-		}
-		return 1;
-	}
-	else if (strcmp(args[0], "setenv") == 0)
+	pid = spawn_command(args, NULL, -1, -1);
+	if (pid == -1)
 	{
-		/* implementation for setenv command */
-		return 1;
+		perror("fork");
+		exit(EXIT_FAILURE);
 	}
-	else if (strcmp(args[0], "unsetenv") == 0)
+	else if (pid > 0)
 	{
-		/* implementation for unsetenv command */
-		return 1;
+		/* Wait for child process to complete */
+		wait_for_child(pid, &status);
 	}
-
-	return 0;
 }
 
 /**
@@ -185,8 +97,8 @@ int handle_builtin_commands(char **args, char *prev_dir)
 int main(int argc, char **argv)
 {
 	char input[MAX_INPUT_LENGTH];
-	char *args[MAX_INPUT_LENGTH];
-	char *prev_dir = NULL;
+	char **args;
+	const builtin_t *builtin;
 
 	while (1)
 	{
@@ -196,8 +108,16 @@ int main(int argc, char **argv)
 		if (read_size == 0)
 			continue;
 
-		if (handle_builtin_commands(args, prev_dir) == 0)
-			execute_command(args[0]);
+		arena_reset();
+		args = parse_command(input);
+		if (args[0] == NULL)
+			continue;
+
+		builtin = find_builtin(args[0]);
+		if (builtin != NULL)
+			run_builtin(builtin, args, NULL);
+		else
+			run_command(args[0]);
 	}
 
 	return (0);
@@ -13,7 +13,8 @@
  */
 void print_prompt(void)
 {
-	write(STDOUT_FILENO, "$ ", 2);
+	if (is_interactive())
+		write(STDOUT_FILENO, "$ ", 2);
 }
 
 /**
@@ -23,60 +24,36 @@ void print_prompt(void)
  */
 ssize_t read_input(char *input)
 {
-	ssize_t read_size = read(STDIN_FILENO, input, MAX_INPUT_LENGTH);
-
-	if (read_size == -1)
-	{
-		perror("read");
-		exit(EXIT_FAILURE);
-	}
-	else if (read_size == 0)
-	{
-		write(STDOUT_FILENO, "\n", 1);
-		exit(EXIT_SUCCESS);
-	}
-	/* Remove newline character from end of command */
-	input[read_size - 1] = '\0';
+	ssize_t read_size = read_line(input, MAX_INPUT_LENGTH);
 	return (read_size);
 }
 
 /**
- * execute_command - executes command
+ * run_command - executes a one-word command
  * @command: command to execute
  */
-void execute_command(char *command)
+void run_command(char *command)
 {
-	pid_t pid = fork();
+	char *args[] = {command, NULL};
+	pid_t pid;
 	int status;
 
+	if (access(command, F_OK) == -1)
+	{
+		write(STDERR_FILENO, "Command not found\n", 18);
+		return;
+	}
+
+	pid = spawn_command(args, NULL, -1, -1);
 	if (pid == -1)
 	{
 		perror("fork");
 		exit(EXIT_FAILURE);
 	}
-	else if (pid == 0)
-	{
-		/* Child process */
-		/* Execute command */
-		if (access(command, F_OK) != -1)
-		{
-			execve(command, NULL, environ);
-			perror("execve");
-			_exit(EXIT_FAILURE);
-		}
-		else
-		{
-			write(STDERR_FILENO, "Command not found\n", 18);
-			_exit(EXIT_FAILURE);
-		}
-	}
-	else
+	else if (pid > 0)
 	{
-		/* Parent process */
 		/* Wait for child process to complete */
-		do {
-			waitpid(pid, &status, WUNTRACED);
-		} while (!WIFEXITED(status) && !WIFSIGNALED(status));
+		wait_for_child(pid, &status);
 	}
 }
 
@@ -90,7 +67,7 @@ void execute_commands(char **commands, int num_commands)
 	for (int i = 0; i < num_commands; i++)
 	{
 		char *command = commands[i];
-		execute_command(command);
+		run_command(command);
 	}
 }
 
@@ -104,7 +81,6 @@ void execute_commands(char **commands, int num_commands)
 int main(int argc, char **argv)
 {
 	char input[MAX_INPUT_LENGTH];
-	char **environ;
 
 	while (1)
 	{
@@ -13,7 +13,8 @@
  */
 void print_prompt(void)
 {
-	write(STDOUT_FILENO, "$ ", 2);
+	if (is_interactive())
+		write(STDOUT_FILENO, "$ ", 2);
 }
 
 /**
@@ -23,21 +24,7 @@ void print_prompt(void)
  */
 ssize_t read_input(char *input)
 {
-	ssize_t read_size = read(STDIN_FILENO, input, MAX_INPUT_LENGTH);
-
-	if (read_size == -1)
-	{
-		perror("read");
-		exit(EXIT_FAILURE);
-	}
-	else if (read_size == 0)
-	{
-		write(STDOUT_FILENO, "\n", 1);
-		exit(EXIT_SUCCESS);
-	}
-
-	/* Remove newline character from end of command */
-	input[read_size - 1] = '\0';
+	read_line(input, MAX_INPUT_LENGTH);
 
 	/* Check for comment and remove it */
 	char *comment = strchr(input, '#');
@@ -48,42 +35,31 @@ ssize_t read_input(char *input)
 }
 
 /**
- * execute_command - executes command
+ * run_command - executes a one-word command
  * @command: command to execute
  */
-void execute_command(char *command)
+void run_command(char *command)
 {
-	pid_t pid = fork();
+	char *args[] = {command, NULL};
+	pid_t pid;
 	int status;
 
+	if (access(command, F_OK) == -1)
+	{
+		write(STDERR_FILENO, "Command not found\n", 18);
+		return;
+	}
+
+	pid = spawn_command(args, NULL, -1, -1);
 	if (pid == -1)
 	{
 		perror("fork");
 		exit(EXIT_FAILURE);
 	}
-	else if (pid == 0)
-	{
-		/* Child process */
-		/* Execute command */
-		if (access(command, F_OK) != -1)
-		{
-			execve(command, NULL, environ);
-			perror("execve");
-			_exit(EXIT_FAILURE);
-		}
-		else
-		{
-			write(STDERR_FILENO, "Command not found\n", 18);
-			_exit(EXIT_FAILURE);
-		}
-	}
-	else
+	else if (pid > 0)
 	{
-		/* Parent process */
 		/* Wait for child process to complete */
-		do {
-			waitpid(pid, &status, WUNTRACED);
-		} while (!WIFEXITED(status) && !WIFSIGNALED(status));
+		wait_for_child(pid, &status);
 	}
 }
 
@@ -97,7 +73,6 @@ void execute_command(char *command)
 int main(int argc, char **argv)
 {
 	char input[MAX_INPUT_LENGTH];
-	environ = argv;  /* Initialize environ with the passed argument vector */
 
 	while (1)
 	{
@@ -108,7 +83,7 @@ int main(int argc, char **argv)
 		if (strlen(input) == 0)
 			continue;
 
-		execute_command(input);
+		run_command(input);
 	}
 
 	return 0;
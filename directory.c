@@ -0,0 +1,497 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "main.h"
+
+#define DIR_STACK_MIN 16
+
+/**
+ * struct dir_entry - a directory saved by pushd
+ * @fd: O_PATH descriptor of the directory, for fchdir
+ * @path: logical path of the directory when it was saved
+ * @dev: device of the directory, 0 if it could not be read
+ * @ino: inode of the directory, 0 if it could not be read
+ */
+typedef struct dir_entry
+{
+	int fd;
+	char *path;
+	dev_t dev;
+	ino_t ino;
+} dir_entry_t;
+
+static dir_entry_t *dir_stack;
+static size_t dir_stack_count;
+static size_t dir_stack_size;
+static char *logical_pwd;
+static size_t logical_pwd_size;
+
+/**
+ * set_logical_pwd - replaces the remembered working directory
+ * @path: new absolute, normalized path
+ */
+static void set_logical_pwd(const char *path)
+{
+	size_t len = strlen(path);
+	char *grown;
+
+	if (len + 1 > logical_pwd_size)
+	{
+		grown = realloc(logical_pwd, len + 1);
+		if (grown == NULL)
+		{
+			perror("malloc");
+			exit(EXIT_FAILURE);
+		}
+		logical_pwd = grown;
+		logical_pwd_size = len + 1;
+	}
+	memcpy(logical_pwd, path, len + 1);
+}
+
+/**
+ * current_directory - returns the logical working directory
+ *
+ * An inherited PWD is trusted when it names the directory the shell
+ * is in; getcwd is only called when it does not, and only once.
+ * Return: absolute path of the working directory
+ */
+const char *current_directory(void)
+{
+	struct stat pwd_st, dot_st;
+	char *pwd;
+
+	if (logical_pwd != NULL)
+		return (logical_pwd);
+
+	pwd = env_get("PWD");
+	if (pwd != NULL && pwd[0] == '/' && stat(pwd, &pwd_st) == 0 &&
+	    stat(".", &dot_st) == 0 && pwd_st.st_dev == dot_st.st_dev &&
+	    pwd_st.st_ino == dot_st.st_ino)
+	{
+		set_logical_pwd(pwd);
+		return (logical_pwd);
+	}
+
+	pwd = getcwd(NULL, 0);
+	if (pwd == NULL)
+	{
+		perror("getcwd");
+		set_logical_pwd("/");
+		return (logical_pwd);
+	}
+	set_logical_pwd(pwd);
+	free(pwd);
+	return (logical_pwd);
+}
+
+/**
+ * normalize_path - removes . and .. components from an absolute path
+ * @path: path to normalize in place
+ *
+ * This is pure string work: a .. drops the previous component
+ * without looking at the file system, as cd -L does.
+ */
+static void normalize_path(char *path)
+{
+	char *src = path, *dst = path, *start;
+	size_t len;
+
+	while (1)
+	{
+		while (*src == '/')
+			src++;
+		if (*src == '\0')
+			break;
+		start = src;
+		while (*src != '\0' && *src != '/')
+			src++;
+		len = src - start;
+
+		if (len == 1 && start[0] == '.')
+			continue;
+		if (len == 2 && start[0] == '.' && start[1] == '.')
+		{
+			while (dst > path && *--dst != '/')
+				;
+			continue;
+		}
+		*dst++ = '/';
+		memmove(dst, start, len);
+		dst += len;
+	}
+	if (dst == path)
+		*dst++ = '/';
+	*dst = '\0';
+}
+
+/**
+ * join_path - joins a directory and a relative path in the arena
+ * @dir: directory
+ * @len: length of @dir
+ * @name: relative path
+ * Return: the joined path
+ */
+static char *join_path(const char *dir, size_t len, const char *name)
+{
+	size_t name_len = strlen(name);
+	char *path = arena_alloc(len + name_len + 2);
+
+	memcpy(path, dir, len);
+	path[len] = '/';
+	memcpy(path + len + 1, name, name_len + 1);
+	return (path);
+}
+
+/**
+ * cdpath_probe - tells whether a CDPATH directory holds a directory
+ * @dir: CDPATH directory, NUL-terminated
+ * @name: operand of cd
+ *
+ * This is a single stat, which is also what checking a cached answer
+ * against the mtime of @dir would cost, so nothing is cached.
+ * Return: 1 if @dir/@name is a directory, 0 otherwise
+ */
+static int cdpath_probe(const char *dir, const char *name)
+{
+	struct stat st;
+
+	if (stat(join_path(dir, strlen(dir), name), &st) != 0)
+		return (0);
+	return (S_ISDIR(st.st_mode));
+}
+
+/**
+ * search_cdpath - resolves a cd operand through CDPATH
+ * @name: operand of cd, a relative path not starting with . or ..
+ * @print: set to 1 when the new directory must be printed
+ * Return: path to change to, allocated in the arena
+ */
+static char *search_cdpath(const char *name, int *print)
+{
+	char *cdpath = env_get("CDPATH"), *end, *dir;
+	size_t len;
+
+	while (cdpath != NULL && *cdpath != '\0')
+	{
+		end = strchr(cdpath, ':');
+		len = end != NULL ? (size_t)(end - cdpath) : strlen(cdpath);
+
+		/* An empty entry stands for the current directory */
+		if (len > 0)
+		{
+			dir = arena_strndup(cdpath, len);
+			if (cdpath_probe(dir, name))
+			{
+				*print = 1;
+				return (join_path(dir, len, name));
+			}
+		}
+		else if (cdpath_probe(".", name))
+		{
+			break;
+		}
+
+		if (end == NULL)
+			break;
+		cdpath = end + 1;
+	}
+	return ((char *)name);
+}
+
+/**
+ * enter_directory - records a directory change in PWD and OLDPWD
+ * @path: absolute, normalized path of the new working directory
+ */
+static void enter_directory(const char *path)
+{
+	env_set("OLDPWD", current_directory(), 1);
+	set_logical_pwd(path);
+	env_set("PWD", logical_pwd, 1);
+}
+
+/**
+ * change_directory - changes directory and updates PWD and OLDPWD
+ * @path: directory to change to
+ * @io: descriptors of the calling builtin
+ * Return: 0 on success, 1 on failure
+ */
+int change_directory(const char *path, builtin_io_t *io)
+{
+	const char *pwd = current_directory();
+	char *target;
+
+	if (path[0] == '/')
+		target = arena_strndup(path, strlen(path));
+	else
+		target = join_path(pwd, strlen(pwd), path);
+	normalize_path(target);
+
+	if (chdir(target) != 0)
+	{
+		write(io->err, "cd: can't cd to ", 16);
+		write(io->err, path, strlen(path));
+		write(io->err, "\n", 1);
+		return (1);
+	}
+
+	enter_directory(target);
+	return (0);
+}
+
+/**
+ * cd_builtin - implements the cd builtin
+ * @argc: number of arguments
+ * @argv: command arguments
+ * @io: descriptors of the builtin
+ *
+ * The working directory is tracked as a string, so cd never has to
+ * ask the kernel where it ended up.
+ * Return: 0 on success, 1 on failure
+ */
+int cd_builtin(int argc, char **argv, builtin_io_t *io)
+{
+	char *path;
+	int print = 0;
+
+	if (argc == 1)
+	{
+		path = env_get("HOME");
+		if (path == NULL)
+		{
+			write(io->err, "cd: No home directory\n", 22);
+			return (1);
+		}
+	}
+	else if (strcmp(argv[1], "-") == 0)
+	{
+		path = env_get("OLDPWD");
+		if (path == NULL)
+		{
+			write(io->err, "cd: No previous directory\n", 26);
+			return (1);
+		}
+		print = 1;
+	}
+	else if (argv[1][0] != '/' && strcmp(argv[1], ".") != 0 &&
+		 strcmp(argv[1], "..") != 0 && strncmp(argv[1], "./", 2) != 0 &&
+		 strncmp(argv[1], "../", 3) != 0)
+	{
+		path = search_cdpath(argv[1], &print);
+	}
+	else
+	{
+		path = argv[1];
+	}
+
+	/* OLDPWD is about to be overwritten */
+	path = arena_strndup(path, strlen(path));
+	if (change_directory(path, io) != 0)
+		return (1);
+
+	if (print)
+	{
+		buffer_puts(logical_pwd);
+		buffer_write("\n", 1);
+	}
+	return (0);
+}
+
+/**
+ * save_directory - opens the working directory for a later fchdir
+ * @entry: set to the saved directory
+ * @io: descriptors of the calling builtin
+ * Return: 0 on success, 1 on failure
+ */
+static int save_directory(dir_entry_t *entry, builtin_io_t *io)
+{
+	const char *pwd = current_directory();
+	struct stat st;
+
+	entry->fd = open(".", O_PATH | O_DIRECTORY | O_CLOEXEC);
+	if (entry->fd == -1)
+	{
+		write(io->err, "pushd: can't open current directory\n", 37);
+		return (1);
+	}
+	entry->dev = 0;
+	entry->ino = 0;
+	if (fstat(entry->fd, &st) == 0)
+	{
+		entry->dev = st.st_dev;
+		entry->ino = st.st_ino;
+	}
+	entry->path = strdup(pwd);
+	if (entry->path == NULL)
+	{
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+	return (0);
+}
+
+/**
+ * restore_directory - returns to a saved directory
+ * @entry: saved directory
+ * @io: descriptors of the calling builtin
+ *
+ * The open descriptor is used, so the path is not resolved again and
+ * the directory is found even if one of its parents was renamed. The
+ * saved path then names another directory, or none, and PWD is taken
+ * from getcwd instead.
+ *
+ * Telling the two apart costs one stat of the saved path once fchdir
+ * has succeeded; the identity of the directory itself was taken at
+ * pushd. The check cannot wait until the path is read, because PWD is
+ * exported to every command that runs next.
+ * Return: 0 on success, 1 on failure
+ */
+static int restore_directory(dir_entry_t *entry, builtin_io_t *io)
+{
+	struct stat path_st;
+	char *path = entry->path, *cwd = NULL;
+
+	if (fchdir(entry->fd) != 0)
+	{
+		write(io->err, "cd: can't cd to ", 16);
+		write(io->err, entry->path, strlen(entry->path));
+		write(io->err, "\n", 1);
+		return (1);
+	}
+
+	if (entry->ino == 0 || stat(path, &path_st) != 0 ||
+	    entry->dev != path_st.st_dev || entry->ino != path_st.st_ino)
+	{
+		cwd = getcwd(NULL, 0);
+		if (cwd != NULL)
+			path = cwd;
+	}
+	enter_directory(path);
+	free(cwd);
+	return (0);
+}
+
+/**
+ * print_directory_stack - prints the working directory and the stack
+ */
+static void print_directory_stack(void)
+{
+	size_t i;
+
+	buffer_puts(current_directory());
+	for (i = dir_stack_count; i > 0; i--)
+	{
+		buffer_write(" ", 1);
+		buffer_puts(dir_stack[i - 1].path);
+	}
+	buffer_write("\n", 1);
+}
+
+/**
+ * pushd_builtin - implements the pushd builtin
+ * @argc: number of arguments
+ * @argv: command arguments
+ * @io: descriptors of the builtin
+ *
+ * With a directory, the working directory is saved and cd is done;
+ * without one, the working directory and the top of the stack swap.
+ * Return: 0 on success, 1 on failure
+ */
+int pushd_builtin(int argc, char **argv, builtin_io_t *io)
+{
+	dir_entry_t *grown, saved;
+
+	if (argc == 1 && dir_stack_count == 0)
+	{
+		write(io->err, "pushd: no other directory\n", 26);
+		return (1);
+	}
+
+	if (dir_stack_count == dir_stack_size)
+	{
+		dir_stack_size = dir_stack_size ? dir_stack_size * 2 : DIR_STACK_MIN;
+		grown = realloc(dir_stack, dir_stack_size * sizeof(*dir_stack));
+		if (grown == NULL)
+		{
+			perror("malloc");
+			exit(EXIT_FAILURE);
+		}
+		dir_stack = grown;
+	}
+	if (save_directory(&saved, io) != 0)
+		return (1);
+
+	if (argc == 1)
+	{
+		if (restore_directory(&dir_stack[dir_stack_count - 1], io) != 0)
+		{
+			close(saved.fd);
+			free(saved.path);
+			return (1);
+		}
+		close(dir_stack[dir_stack_count - 1].fd);
+		free(dir_stack[dir_stack_count - 1].path);
+		dir_stack[dir_stack_count - 1] = saved;
+	}
+	else
+	{
+		if (change_directory(argv[1], io) != 0)
+		{
+			close(saved.fd);
+			free(saved.path);
+			return (1);
+		}
+		dir_stack[dir_stack_count++] = saved;
+	}
+
+	print_directory_stack();
+	return (0);
+}
+
+/**
+ * popd_builtin - implements the popd builtin
+ * @argc: number of arguments
+ * @argv: command arguments
+ * @io: descriptors of the builtin
+ * Return: 0 on success, 1 on failure
+ */
+int popd_builtin(int argc, char **argv, builtin_io_t *io)
+{
+	dir_entry_t *top;
+
+	(void)argc;
+	(void)argv;
+
+	if (dir_stack_count == 0)
+	{
+		write(io->err, "popd: directory stack empty\n", 28);
+		return (1);
+	}
+
+	top = &dir_stack[dir_stack_count - 1];
+	if (restore_directory(top, io) != 0)
+		return (1);
+	close(top->fd);
+	free(top->path);
+	dir_stack_count--;
+
+	print_directory_stack();
+	return (0);
+}
+
+/**
+ * dirs_builtin - implements the dirs builtin
+ * @argc: number of arguments
+ * @argv: command arguments
+ * @io: descriptors of the builtin
+ * Return: always 0
+ */
+int dirs_builtin(int argc, char **argv, builtin_io_t *io)
+{
+	(void)argc;
+	(void)argv;
+	(void)io;
+
+	print_directory_stack();
+	return (0);
+}
@@ -0,0 +1,491 @@
+#include <errno.h>
+#include "main.h"
+
+extern char **environ;
+
+#define ENV_MIN_BUCKETS 64
+
+/**
+ * struct env_entry - a shell variable
+ * @pair: "NAME=value", ready to be handed to execve
+ * @name_len: length of the name part of @pair
+ * @exported: 1 if the variable is passed on to children
+ * @next: next entry in the same bucket
+ * @order_prev: previous entry in definition order
+ * @order_next: next entry in definition order
+ */
+typedef struct env_entry
+{
+	char *pair;
+	size_t name_len;
+	int exported;
+	struct env_entry *next;
+	struct env_entry *order_prev;
+	struct env_entry *order_next;
+} env_entry_t;
+
+static env_entry_t **env_table;
+static size_t env_capacity;
+static size_t env_count;
+static env_entry_t *env_first;
+static env_entry_t *env_last;
+static int env_loaded;
+
+static char **env_envp;
+static size_t env_envp_size;
+static int env_dirty = 1;
+
+/**
+ * env_hash - computes the bucket of a variable name (djb2)
+ * @name: variable name
+ * @len: length of the name
+ * Return: bucket index
+ */
+static size_t env_hash(const char *name, size_t len)
+{
+	unsigned long hash = 5381;
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		hash = hash * 33 + (unsigned char)name[i];
+	return (hash & (env_capacity - 1));
+}
+
+/**
+ * env_grow - doubles the bucket table and rehashes it
+ *
+ * The table is kept at most half full, so chains stay short however
+ * many variables a script defines.
+ */
+static void env_grow(void)
+{
+	env_entry_t *entry;
+	size_t bucket;
+
+	free(env_table);
+	env_capacity = env_capacity ? env_capacity * 2 : ENV_MIN_BUCKETS;
+	env_table = calloc(env_capacity, sizeof(*env_table));
+	if (env_table == NULL)
+	{
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+
+	for (entry = env_first; entry != NULL; entry = entry->order_next)
+	{
+		bucket = env_hash(entry->pair, entry->name_len);
+		entry->next = env_table[bucket];
+		env_table[bucket] = entry;
+	}
+}
+
+/**
+ * env_find - looks up a variable
+ * @name: variable name
+ * @len: length of the name
+ * Return: the entry, NULL if the variable is not set
+ */
+static env_entry_t *env_find(const char *name, size_t len)
+{
+	env_entry_t *entry;
+
+	if (env_capacity == 0)
+		return (NULL);
+	for (entry = env_table[env_hash(name, len)]; entry != NULL;
+	     entry = entry->next)
+	{
+		if (entry->name_len == len && memcmp(entry->pair, name, len) == 0)
+			return (entry);
+	}
+	return (NULL);
+}
+
+/**
+ * env_store_pair - creates or replaces a variable from its pair
+ * @name: variable name
+ * @len: length of the name
+ * @pair: malloc'd "NAME=value" string, owned by the store afterwards
+ * @export: 1 to export the variable, 0 to keep its current flag
+ */
+static void env_store_pair(const char *name, size_t len, char *pair, int export)
+{
+	env_entry_t *entry = env_find(name, len);
+	size_t bucket;
+
+	if (entry != NULL)
+	{
+		free(entry->pair);
+		entry->pair = pair;
+		if (export)
+			entry->exported = 1;
+		if (entry->exported)
+			env_dirty = 1;
+		return;
+	}
+
+	entry = malloc(sizeof(*entry));
+	if (entry == NULL)
+	{
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+	if ((env_count + 1) * 2 > env_capacity)
+		env_grow();
+	env_count++;
+	bucket = env_hash(name, len);
+	entry->pair = pair;
+	entry->name_len = len;
+	entry->exported = export;
+	entry->next = env_table[bucket];
+	env_table[bucket] = entry;
+
+	entry->order_next = NULL;
+	entry->order_prev = env_last;
+	if (env_last != NULL)
+		env_last->order_next = entry;
+	else
+		env_first = entry;
+	env_last = entry;
+
+	if (export)
+		env_dirty = 1;
+}
+
+/**
+ * env_load - copies the inherited environment into the store
+ */
+static void env_load(void)
+{
+	char **env;
+	char *pair, *equal;
+
+	env_loaded = 1;
+	for (env = environ; env != NULL && *env != NULL; env++)
+	{
+		equal = strchr(*env, '=');
+		if (equal == NULL)
+			continue;
+		pair = strdup(*env);
+		if (pair == NULL)
+		{
+			perror("malloc");
+			exit(EXIT_FAILURE);
+		}
+		env_store_pair(pair, equal - *env, pair, 1);
+	}
+}
+
+/**
+ * env_get - looks up the value of a shell variable
+ * @name: variable name
+ * Return: the value, NULL if the variable is not set
+ */
+char *env_get(const char *name)
+{
+	size_t len = strlen(name);
+	env_entry_t *entry;
+
+	if (!env_loaded)
+		env_load();
+
+	entry = env_find(name, len);
+	return (entry != NULL ? entry->pair + len + 1 : NULL);
+}
+
+/**
+ * env_set - sets a shell variable
+ * @name: variable name
+ * @value: new value
+ * @export: 1 to export the variable, 0 to keep its current flag
+ *
+ * The envp handed to children is only marked for rebuilding when an
+ * exported variable changes. Remembered command locations are
+ * forgotten when PATH changes, however it is set.
+ * Return: 0 on success, -1 if the name is invalid
+ */
+int env_set(const char *name, const char *value, int export)
+{
+	size_t len = strlen(name), value_len = strlen(value);
+	char *pair;
+
+	if (len == 0 || strchr(name, '=') != NULL)
+	{
+		errno = EINVAL;
+		return (-1);
+	}
+	if (!env_loaded)
+		env_load();
+
+	pair = malloc(len + value_len + 2);
+	if (pair == NULL)
+		return (-1);
+	memcpy(pair, name, len);
+	pair[len] = '=';
+	memcpy(pair + len + 1, value, value_len + 1);
+
+	env_store_pair(pair, len, pair, export);
+	if (strcmp(name, "PATH") == 0)
+		hash_reset();
+	return (0);
+}
+
+/**
+ * env_unset - removes a shell variable
+ * @name: variable name
+ * Return: 0 on success, -1 if the name is invalid
+ */
+int env_unset(const char *name)
+{
+	size_t len = strlen(name);
+	env_entry_t **link, *entry;
+
+	if (len == 0 || strchr(name, '=') != NULL)
+	{
+		errno = EINVAL;
+		return (-1);
+	}
+	if (!env_loaded)
+		env_load();
+	if (env_capacity == 0)
+		return (0);
+
+	link = &env_table[env_hash(name, len)];
+	while ((entry = *link) != NULL)
+	{
+		if (entry->name_len == len && memcmp(entry->pair, name, len) == 0)
+			break;
+		link = &entry->next;
+	}
+	if (entry == NULL)
+		return (0);
+
+	*link = entry->next;
+	env_count--;
+	if (entry->order_prev != NULL)
+		entry->order_prev->order_next = entry->order_next;
+	else
+		env_first = entry->order_next;
+	if (entry->order_next != NULL)
+		entry->order_next->order_prev = entry->order_prev;
+	else
+		env_last = entry->order_prev;
+
+	if (entry->exported)
+		env_dirty = 1;
+	free(entry->pair);
+	free(entry);
+	if (strcmp(name, "PATH") == 0)
+		hash_reset();
+	return (0);
+}
+
+/**
+ * assignment_name_length - recognises a NAME=value word
+ * @word: word to check
+ * Return: length of NAME, 0 if the word is not an assignment
+ */
+size_t assignment_name_length(const char *word)
+{
+	size_t len;
+
+	if (!(word[0] == '_' || (word[0] >= 'A' && word[0] <= 'Z') ||
+	      (word[0] >= 'a' && word[0] <= 'z')))
+		return (0);
+
+	for (len = 1; word[len] != '='; len++)
+	{
+		if (!(word[len] == '_' || (word[len] >= 'A' && word[len] <= 'Z') ||
+		      (word[len] >= 'a' && word[len] <= 'z') ||
+		      (word[len] >= '0' && word[len] <= '9')))
+			return (0);
+	}
+	return (len);
+}
+
+/**
+ * env_assign - sets a shell variable from a NAME=value word
+ * @word: assignment word
+ *
+ * The variable keeps its exported flag; a new one is not exported.
+ * Return: 0 on success, -1 on error
+ */
+int env_assign(const char *word)
+{
+	size_t len = assignment_name_length(word);
+
+	if (len == 0)
+	{
+		errno = EINVAL;
+		return (-1);
+	}
+	return (env_set(arena_strndup(word, len), word + len + 1, 0));
+}
+
+/**
+ * env_overlay - builds the environment of one command from its prefix
+ * @assignments: NAME=value words written before the command
+ * @count: number of assignments
+ *
+ * The overlay is allocated in the arena next to the argument vector,
+ * so the store is left untouched and there is nothing to restore.
+ * Return: NULL-terminated environment for the child
+ */
+char **env_overlay(char **assignments, int count)
+{
+	char **base = env_environ(), **envp;
+	size_t base_count, len, n = 0;
+	int i, j;
+
+	for (base_count = 0; base[base_count] != NULL; base_count++)
+		;
+	envp = arena_alloc((count + base_count + 1) * sizeof(*envp));
+
+	for (i = 0; i < count; i++)
+	{
+		/* A later assignment to the same name wins */
+		len = assignment_name_length(assignments[i]);
+		for (j = i + 1; j < count; j++)
+		{
+			if (strncmp(assignments[j], assignments[i], len + 1) == 0)
+				break;
+		}
+		if (j == count)
+			envp[n++] = assignments[i];
+	}
+
+	for (; base_count > 0; base++, base_count--)
+	{
+		for (i = 0; i < count; i++)
+		{
+			len = assignment_name_length(assignments[i]);
+			if (strncmp(*base, assignments[i], len + 1) == 0)
+				break;
+		}
+		if (i == count)
+			envp[n++] = *base;
+	}
+	envp[n] = NULL;
+
+	return (envp);
+}
+
+/**
+ * env_push - applies the prefix assignments of a builtin to the store
+ * @assignments: NULL-terminated NAME=value words, NULL for none
+ *
+ * A builtin runs in the shell and reads the store itself, so its
+ * assignments are set there, exported, until env_pop puts back what
+ * was there before.
+ * Return: the previous state of the variables, allocated in the
+ * arena, NULL if there were no assignments
+ */
+env_saved_t *env_push(char **assignments)
+{
+	env_saved_t *saved;
+	env_entry_t *entry;
+	size_t len;
+	int i, count;
+
+	if (assignments == NULL)
+		return (NULL);
+	if (!env_loaded)
+		env_load();
+
+	for (count = 0; assignments[count] != NULL; count++)
+		;
+	saved = arena_alloc((count + 1) * sizeof(*saved));
+	for (i = 0; i < count; i++)
+	{
+		len = assignment_name_length(assignments[i]);
+		saved[i].name = arena_strndup(assignments[i], len);
+		entry = env_find(saved[i].name, len);
+		saved[i].value = NULL;
+		saved[i].exported = 0;
+		if (entry != NULL)
+		{
+			saved[i].value = arena_strndup(entry->pair + len + 1,
+						       strlen(entry->pair + len + 1));
+			saved[i].exported = entry->exported;
+		}
+		env_set(saved[i].name, assignments[i] + len + 1, 1);
+	}
+	saved[count].name = NULL;
+	return (saved);
+}
+
+/**
+ * env_pop - restores the variables changed by env_push
+ * @saved: value returned by env_push
+ */
+void env_pop(env_saved_t *saved)
+{
+	env_entry_t *entry;
+	int i;
+
+	if (saved == NULL)
+		return;
+
+	for (i = 0; saved[i].name != NULL; i++)
+		;
+	/* Backwards, so a name assigned twice gets its oldest value */
+	while (i-- > 0)
+	{
+		if (saved[i].value == NULL)
+		{
+			env_unset(saved[i].name);
+			continue;
+		}
+		env_set(saved[i].name, saved[i].value, 0);
+		entry = env_find(saved[i].name, strlen(saved[i].name));
+		if (entry != NULL && entry->exported != saved[i].exported)
+		{
+			entry->exported = saved[i].exported;
+			env_dirty = 1;
+		}
+	}
+}
+
+/**
+ * env_environ - returns the environment to pass to children
+ *
+ * The array is rebuilt only after an exported variable has changed;
+ * otherwise the one built last time is returned as is.
+ * Return: NULL-terminated array of "NAME=value" strings
+ */
+char **env_environ(void)
+{
+	env_entry_t *entry;
+	size_t count = 0;
+	char **grown;
+
+	if (!env_loaded)
+		env_load();
+	if (!env_dirty)
+		return (env_envp);
+
+	for (entry = env_first; entry != NULL; entry = entry->order_next)
+		count += entry->exported;
+
+	if (count + 1 > env_envp_size)
+	{
+		grown = realloc(env_envp, (count + 1) * 2 * sizeof(*grown));
+		if (grown == NULL)
+		{
+			perror("malloc");
+			exit(EXIT_FAILURE);
+		}
+		env_envp = grown;
+		env_envp_size = (count + 1) * 2;
+	}
+
+	count = 0;
+	for (entry = env_first; entry != NULL; entry = entry->order_next)
+	{
+		if (entry->exported)
+			env_envp[count++] = entry->pair;
+	}
+	env_envp[count] = NULL;
+	env_dirty = 0;
+
+	return (env_envp);
+}
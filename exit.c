@@ -13,41 +13,40 @@ extern char **environ;
 
 void print_prompt(void)
 {
-	write(STDOUT_FILENO, "$ ", 2);
+	if (is_interactive())
+		write(STDOUT_FILENO, "$ ", 2);
 }
 
 ssize_t read_command(char *input)
 {
-	ssize_t read_size = read(STDIN_FILENO, input, MAX_INPUT_LENGTH);
-
-	if (read_size == -1)
-	{
-		perror("read");
-		exit(EXIT_FAILURE);
-	}
-	else if (read_size == 0)
-	{
-		write(STDOUT_FILENO, "\n", 1);
-		exit(EXIT_SUCCESS);
-	}
-
-	/* Remove newline character from end of command */
-	input[read_size - 1] = '\0';
+	ssize_t read_size = read_line(input, MAX_INPUT_LENGTH);
 
 	return read_size;
 }
 
-void parse_command(char *input, char **args)
+char **parse_command(char *input)
 {
+	size_t size = MAX_NUM_ARGS, i = 0;
+	char **args = arena_alloc(size * sizeof(*args));
+	char **grown;
 	char *arg = strtok(input, " ");
-	int i = 0;
 
-	while (arg != NULL && i < MAX_NUM_ARGS - 1)
+	while (arg != NULL)
 	{
+		/* Grow the argument vector instead of truncating the command */
+		if (i == size - 1)
+		{
+			grown = arena_alloc(2 * size * sizeof(*args));
+			memcpy(grown, args, i * sizeof(*args));
+			args = grown;
+			size *= 2;
+		}
 		args[i++] = arg;
 		arg = strtok(NULL, " ");
 	}
 	args[i] = NULL;
+
+	return (args);
 }
 
 int check_command_exists(char *command)
@@ -60,41 +59,20 @@ int check_command_exists(char *command)
 	return 1;
 }
 
-void execute_command(char **args)
-{
-	execve(args[0], args, environ);
-	perror("execve");
-	_exit(EXIT_FAILURE);
-}
-
-void wait_for_child(pid_t pid, int *status)
-{
-	do
-	{
-		waitpid(pid, status, WUNTRACED);
-	} while (!WIFEXITED(*status) && !WIFSIGNALED(*status));
-}
-
 void handle_command_execution(char **args)
 {
 	pid_t pid;
 	int status;
 
 	/* Create child process */
-	pid = fork();
+	pid = spawn_command(args, NULL, -1, -1);
 
 	if (pid == -1)
 	{
 		perror("fork");
 		exit(EXIT_FAILURE);
 	}
-	else if (pid == 0)
-	{
-		/* Child process */
-		/* Execute command */
-		execute_command(args);
-	}
-	else
+	else if (pid > 0)
 	{
 		/* Parent process */
 		/* Wait for child process to complete */
@@ -105,26 +83,34 @@ void handle_command_execution(char **args)
 int main(int argc, char **argv)
 {
 	char input[MAX_INPUT_LENGTH];
-	char *args[MAX_NUM_ARGS];
+	char **args;
+	const builtin_t *builtin;
 
 	while (1)
 	{
+		/* Release the previous command line */
+		arena_reset();
+
 		/* Print prompt */
 		print_prompt();
 
 		/* Read command from user */
 		ssize_t read_size = read_command(input);
 
-		/* Check if command is "exit" */
-		if (input[0] == 'e' && input[1] == 'x' && input[2] == 'i' && input[3] == 't' && input[4] == '\0')
+		/* Parse command into arguments */
+		args = parse_command(input);
+
+		if (args[0] == NULL)
+			continue;
+
+		/* Check for builtins such as exit */
+		builtin = find_builtin(args[0]);
+		if (builtin != NULL)
 		{
-			/* Exit the shell program */
-			_exit(EXIT_SUCCESS);
+			run_builtin(builtin, args, NULL);
+			continue;
 		}
 
-		/* Parse command into arguments */
-		parse_command(input, args);
-
 		/* Check if command exists in PATH */
 		if (!check_command_exists(args[0]))
 		{
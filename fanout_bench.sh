@@ -0,0 +1,39 @@
+#!/bin/bash
+
+# Measure spawn and reap throughput of background jobs
+# Usage: ./fanout_bench.sh ./hsh [N...]
+#
+# For each N (default 100 1000 10000), starts N background children
+# from one script and waits for all of them: once with children that
+# exit at once, and once with N children alive together for a second.
+
+shell=${1:?usage: $0 SHELL [N...]}
+shift
+counts=${*:-100 1000 10000}
+script=$(mktemp)
+trap 'rm -f "$script"' EXIT
+
+# One pidfd per live child
+ulimit -n "$(ulimit -Hn)"
+
+run()
+{
+	local n=$1 command=$2 start end ms
+
+	for ((i = 0; i < n; i++)); do
+		echo "$command &"
+	done > "$script"
+	echo "wait" >> "$script"
+
+	start=$(date +%s%N)
+	"$shell" "$script"
+	end=$(date +%s%N)
+	ms=$(((end - start) / 1000000))
+	printf '%6d x %-8s %6d ms  %6d children/s\n' "$n" "$command" "$ms" \
+		"$((n * 1000 / (ms > 0 ? ms : 1)))"
+}
+
+for n in $counts; do
+	run "$n" true
+	run "$n" "sleep 1"
+done
@@ -0,0 +1,418 @@
+#include <errno.h>
+#include <limits.h>
+#include <sys/inotify.h>
+#include "main.h"
+
+#define HASH_TABLE_SIZE 64
+#define PATH_WATCH_MAX 64
+#define PATH_WATCH_MASK (IN_CREATE | IN_MOVED_TO | IN_ATTRIB | \
+			 IN_DELETE_SELF | IN_MOVE_SELF)
+
+/**
+ * struct hash_entry - a command remembered by the PATH hash table
+ * @name: command name as typed
+ * @path: absolute path the name resolved to, NULL if it is known
+ * to be missing from every PATH directory
+ * @hits: number of times the entry was used
+ * @next: next entry in the same bucket
+ */
+typedef struct hash_entry
+{
+	char *name;
+	char *path;
+	unsigned int hits;
+	struct hash_entry *next;
+} hash_entry_t;
+
+static hash_entry_t *hash_table[HASH_TABLE_SIZE];
+static unsigned long hash_hits;
+static unsigned long hash_misses;
+static unsigned long hash_negative_hits;
+
+/* inotify instance watching the PATH directories, -1 when unset */
+static int path_watch_fd = -1;
+static int path_watches[PATH_WATCH_MAX];
+static int path_watch_count;
+/* 1 when missing commands may be cached, 0 if not, -1 if unknown */
+static int negative_cache = -1;
+
+/**
+ * hash_name - computes the bucket of a command name (djb2)
+ * @name: command name
+ * Return: bucket index
+ */
+static unsigned int hash_name(const char *name)
+{
+	unsigned long hash = 5381;
+
+	while (*name != '\0')
+		hash = hash * 33 + (unsigned char)*name++;
+	return (hash % HASH_TABLE_SIZE);
+}
+
+/**
+ * search_path - walks a PATH looking for an executable
+ * @name: command name
+ * @dir: colon-separated directories, NULL for none
+ * Return: malloc'd absolute path, NULL if not found
+ */
+static char *search_path(const char *name, const char *dir)
+{
+	char full[PATH_MAX];
+	const char *end;
+	size_t dir_len, name_len = strlen(name);
+
+	if (dir == NULL)
+		return (NULL);
+
+	while (1)
+	{
+		end = strchr(dir, ':');
+		dir_len = end != NULL ? (size_t)(end - dir) : strlen(dir);
+
+		/* An empty PATH element means the current directory */
+		if (dir_len == 0)
+			memcpy(full, ".", (dir_len = 1));
+		else if (dir_len + name_len + 2 <= sizeof(full))
+			memcpy(full, dir, dir_len);
+		else
+			dir_len = 0;
+
+		if (dir_len != 0)
+		{
+			full[dir_len] = '/';
+			memcpy(full + dir_len + 1, name, name_len + 1);
+			if (access(full, X_OK) == 0)
+				return (strdup(full));
+		}
+
+		if (end == NULL)
+			return (NULL);
+		dir = end + 1;
+	}
+}
+
+/**
+ * watch_directory - adds an inotify watch for one PATH directory
+ * @dir: directory to watch, modified in place
+ *
+ * A directory that does not exist yet is covered by watching the
+ * closest ancestor that does, so its creation is noticed too.
+ * Return: 0 on success, -1 if the directory cannot be watched
+ */
+static int watch_directory(char *dir)
+{
+	char *slash;
+	int watch;
+
+	if (dir[0] != '/' || path_watch_count == PATH_WATCH_MAX)
+		return (-1);
+
+	while ((watch = inotify_add_watch(path_watch_fd, dir,
+					  PATH_WATCH_MASK)) == -1)
+	{
+		if (errno != ENOENT && errno != ENOTDIR)
+			return (-1);
+		slash = strrchr(dir, '/');
+		if (slash == NULL || slash == dir)
+			dir = "/";
+		else
+			*slash = '\0';
+	}
+	path_watches[path_watch_count++] = watch;
+	return (0);
+}
+
+/**
+ * unwatch_path_directories - removes every watch on the PATH directories
+ *
+ * The inotify instance is kept, as closing it waits for the kernel to
+ * release it, and the events left pending are discarded.
+ */
+static void unwatch_path_directories(void)
+{
+	char events[4096]
+		__attribute__((aligned(__alignof__(struct inotify_event))));
+
+	while (path_watch_count > 0)
+		inotify_rm_watch(path_watch_fd, path_watches[--path_watch_count]);
+	if (path_watch_fd != -1)
+	{
+		while (read(path_watch_fd, events, sizeof(events)) > 0)
+			;
+	}
+}
+
+/**
+ * watch_path_directories - starts watching every $PATH directory
+ *
+ * Missing commands are only cached when all of PATH can be watched;
+ * relative entries depend on the current directory and cannot be.
+ */
+static void watch_path_directories(void)
+{
+	char dir[PATH_MAX];
+	char *path = env_get("PATH");
+	char *end;
+	size_t dir_len;
+
+	negative_cache = 0;
+	if (path == NULL)
+		return;
+
+	if (path_watch_fd == -1)
+		path_watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (path_watch_fd == -1)
+		return;
+
+	while (1)
+	{
+		end = strchr(path, ':');
+		dir_len = end != NULL ? (size_t)(end - path) : strlen(path);
+		if (dir_len == 0 || dir_len >= sizeof(dir))
+			return;
+		memcpy(dir, path, dir_len);
+		dir[dir_len] = '\0';
+		if (watch_directory(dir) == -1)
+			return;
+
+		if (end == NULL)
+			break;
+		path = end + 1;
+	}
+	negative_cache = 1;
+}
+
+/**
+ * drop_missing_commands - forgets every command cached as missing
+ */
+static void drop_missing_commands(void)
+{
+	hash_entry_t **link, *entry;
+	int i;
+
+	for (i = 0; i < HASH_TABLE_SIZE; i++)
+	{
+		link = &hash_table[i];
+		while ((entry = *link) != NULL)
+		{
+			if (entry->path == NULL)
+			{
+				*link = entry->next;
+				free(entry->name);
+				free(entry);
+			}
+			else
+			{
+				link = &entry->next;
+			}
+		}
+	}
+}
+
+/**
+ * path_directories_changed - checks for changes in the PATH directories
+ *
+ * Pending inotify events are drained; if there were any, the cached
+ * missing commands are dropped and the watches are set up again on
+ * the next miss. A watched ancestor may now have the PATH directory
+ * itself below it, and a watched directory may have gone.
+ * Return: 1 if a PATH directory changed, 0 otherwise
+ */
+static int path_directories_changed(void)
+{
+	char events[4096]
+		__attribute__((aligned(__alignof__(struct inotify_event))));
+	int changed = 0;
+
+	while (read(path_watch_fd, events, sizeof(events)) > 0)
+		changed = 1;
+
+	if (changed)
+	{
+		drop_missing_commands();
+		unwatch_path_directories();
+		negative_cache = -1;
+	}
+	return (changed);
+}
+
+/**
+ * find_command - resolves a command to the path that should be executed
+ * @command: command name or path
+ *
+ * Names without a slash are looked up in the hash table first and
+ * only searched in $PATH on a miss. Names known to be missing are
+ * cached too, until inotify reports a change in a PATH directory.
+ * Return: path of the command, NULL if it does not exist
+ */
+char *find_command(char *command)
+{
+	unsigned int bucket;
+	hash_entry_t *entry;
+	char *path;
+
+	if (strchr(command, '/') != NULL)
+		return (access(command, F_OK) == 0 ? command : NULL);
+
+	bucket = hash_name(command);
+	for (entry = hash_table[bucket]; entry != NULL; entry = entry->next)
+	{
+		if (strcmp(entry->name, command) == 0)
+			break;
+	}
+
+	if (entry != NULL && entry->path == NULL && path_directories_changed())
+		entry = NULL;
+	if (entry != NULL)
+	{
+		if (entry->path == NULL)
+			hash_negative_hits++;
+		else
+			hash_hits++;
+		entry->hits++;
+		return (entry->path);
+	}
+
+	hash_misses++;
+	if (negative_cache == -1)
+		watch_path_directories();
+	path = search_path(command, env_get("PATH"));
+	if (path == NULL && negative_cache != 1)
+		return (NULL);
+
+	entry = malloc(sizeof(*entry));
+	if (entry == NULL)
+		return (path);
+	entry->name = strdup(command);
+	entry->path = path;
+	entry->hits = 1;
+	entry->next = hash_table[bucket];
+	hash_table[bucket] = entry;
+
+	return (path);
+}
+
+/**
+ * find_command_in - resolves a command against a PATH of its own
+ * @command: command name or path
+ * @path: directories to search, such as the value of a PATH=...
+ * prefix assignment
+ *
+ * The hash table only remembers what the shell's PATH resolves to,
+ * so it is neither consulted nor filled.
+ * Return: path of the command, allocated in the arena, NULL if it
+ * does not exist
+ */
+char *find_command_in(char *command, const char *path)
+{
+	char *found, *copy;
+
+	if (strchr(command, '/') != NULL)
+		return (access(command, F_OK) == 0 ? command : NULL);
+
+	found = search_path(command, path);
+	if (found == NULL)
+		return (NULL);
+	copy = arena_strndup(found, strlen(found));
+	free(found);
+	return (copy);
+}
+
+/**
+ * hash_reset - forgets every remembered command
+ */
+void hash_reset(void)
+{
+	hash_entry_t *entry, *next;
+	int i;
+
+	for (i = 0; i < HASH_TABLE_SIZE; i++)
+	{
+		for (entry = hash_table[i]; entry != NULL; entry = next)
+		{
+			next = entry->next;
+			free(entry->name);
+			free(entry->path);
+			free(entry);
+		}
+		hash_table[i] = NULL;
+	}
+
+	unwatch_path_directories();
+	negative_cache = -1;
+}
+
+/**
+ * print_hits - prints a hit counter right-aligned in four columns
+ * @hits: counter to print
+ */
+static void print_hits(unsigned int hits)
+{
+	unsigned int width = 1, n;
+
+	for (n = hits; n >= 10; n /= 10)
+		width++;
+	for (; width < 4; width++)
+		buffer_write(" ", 1);
+	buffer_put_number(hits);
+}
+
+/**
+ * print_hash_table - lists remembered commands and the hit counters
+ */
+void print_hash_table(void)
+{
+	hash_entry_t *entry;
+	int i, empty = 1;
+
+	for (i = 0; i < HASH_TABLE_SIZE; i++)
+	{
+		for (entry = hash_table[i]; entry != NULL; entry = entry->next)
+		{
+			if (entry->path == NULL)
+				continue;
+			if (empty)
+				buffer_puts("hits\tcommand\n");
+			empty = 0;
+			print_hits(entry->hits);
+			buffer_write("\t", 1);
+			buffer_puts(entry->path);
+			buffer_write("\n", 1);
+		}
+	}
+
+	if (empty)
+		buffer_puts("hash: hash table empty\n");
+	buffer_puts("hash: ");
+	buffer_put_number(hash_hits);
+	buffer_puts(" hits, ");
+	buffer_put_number(hash_misses);
+	buffer_puts(" misses, ");
+	buffer_put_number(hash_negative_hits);
+	buffer_puts(" negative hits\n");
+}
+
+/**
+ * hash_builtin - implements the hash builtin
+ * @argc: number of arguments
+ * @argv: command arguments
+ * @io: descriptors of the builtin
+ * Return: 0 on success, 1 on bad usage
+ */
+int hash_builtin(int argc, char **argv, builtin_io_t *io)
+{
+	if (argc == 1)
+	{
+		print_hash_table();
+		return (0);
+	}
+	if (argc == 2 && strcmp(argv[1], "-r") == 0)
+	{
+		hash_reset();
+		return (0);
+	}
+
+	write(io->err, "Usage: hash [-r]\n", 17);
+	return (1);
+}
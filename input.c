@@ -0,0 +1,263 @@
+#include <errno.h>
+#include "main.h"
+
+#define INPUT_BUFFER_SIZE (64 * 1024)
+
+static char input_buffer[INPUT_BUFFER_SIZE];
+static size_t input_pos;
+static size_t input_size;
+static int interactive = -1;
+
+/**
+ * is_interactive - tells whether the shell reads from a terminal
+ * Return: 1 if stdin is a terminal, 0 otherwise
+ */
+int is_interactive(void)
+{
+	if (interactive == -1)
+		interactive = isatty(STDIN_FILENO);
+	return (interactive);
+}
+
+/**
+ * fill_input - reads the next block of stdin
+ * Return: number of bytes read, 0 at end of input
+ */
+static size_t fill_input(void)
+{
+	ssize_t read_size;
+
+	/* Keep reaping background jobs while waiting for input */
+	jobs_wait_input(STDIN_FILENO);
+	do {
+		read_size = read(STDIN_FILENO, input_buffer, INPUT_BUFFER_SIZE);
+	} while (read_size == -1 && errno == EINTR);
+
+	if (read_size == -1)
+	{
+		perror("read");
+		exit(EXIT_FAILURE);
+	}
+
+	input_pos = 0;
+	input_size = read_size;
+	return (input_size);
+}
+
+/**
+ * read_line - reads the next command line from stdin
+ * @input: buffer to store the line, without its newline
+ * @size: size of @input
+ *
+ * stdin is read in large blocks and every complete line in a block
+ * is returned by its own call, so commands piped in together are
+ * not glued into one. A line that does not fit in @input is reported
+ * and skipped whole rather than run cut short.
+ * The shell exits at end of input, like the old per-prompt read did.
+ * Return: length of the line
+ */
+ssize_t read_line(char *input, size_t size)
+{
+	size_t len = 0, chunk;
+	char *newline;
+	int too_long = 0;
+
+	while (1)
+	{
+		if (input_pos == input_size && fill_input() == 0)
+		{
+			/* A last line without a newline still runs */
+			if (len > 0 && !too_long)
+				break;
+			if (too_long)
+				write(STDERR_FILENO, "Line too long\n", 14);
+			if (is_interactive())
+				write(STDOUT_FILENO, "\n", 1);
+			exit(EXIT_SUCCESS);
+		}
+
+		newline = memchr(input_buffer + input_pos, '\n',
+				 input_size - input_pos);
+		chunk = newline != NULL ? (size_t)(newline - input_buffer) - input_pos
+			: input_size - input_pos;
+
+		if (len + chunk > size - 1)
+			too_long = 1;
+		else
+			memcpy(input + len, input_buffer + input_pos, chunk);
+		len += chunk;
+
+		if (newline != NULL)
+		{
+			input_pos = newline - input_buffer + 1;
+			if (!too_long)
+				break;
+			write(STDERR_FILENO, "Line too long\n", 14);
+			len = 0;
+			too_long = 0;
+			continue;
+		}
+		input_pos = input_size;
+	}
+
+	input[len] = '\0';
+	return (len);
+}
+
+/**
+ * read_long_line - reads the next command line from stdin, however long
+ * @input: buffer holding the line, grown with realloc as needed
+ * @size: size of @input, updated when it grows
+ *
+ * Lines are split as read_line does, but the buffer grows a block at
+ * a time, as the script reader's does, instead of cutting off a long
+ * line.
+ * Return: length of the line
+ */
+ssize_t read_long_line(char **input, size_t *size)
+{
+	size_t len = 0, chunk, grown_size;
+	char *newline, *grown;
+
+	while (1)
+	{
+		if (input_pos == input_size && fill_input() == 0)
+		{
+			/* A last line without a newline still runs */
+			if (len > 0)
+				break;
+			if (is_interactive())
+				write(STDOUT_FILENO, "\n", 1);
+			exit(EXIT_SUCCESS);
+		}
+
+		newline = memchr(input_buffer + input_pos, '\n',
+				 input_size - input_pos);
+		chunk = newline != NULL ? (size_t)(newline - input_buffer) - input_pos
+			: input_size - input_pos;
+
+		if (len + chunk + 1 > *size)
+		{
+			/* Whole blocks, with room for the NUL */
+			grown_size = (len + chunk) / INPUT_BUFFER_SIZE * INPUT_BUFFER_SIZE
+				+ INPUT_BUFFER_SIZE;
+			grown = realloc(*input, grown_size);
+			if (grown == NULL)
+			{
+				perror("realloc");
+				exit(EXIT_FAILURE);
+			}
+			*input = grown;
+			*size = grown_size;
+		}
+		memcpy(*input + len, input_buffer + input_pos, chunk);
+		len += chunk;
+
+		if (newline != NULL)
+		{
+			input_pos = newline - input_buffer + 1;
+			break;
+		}
+		input_pos = input_size;
+	}
+
+	(*input)[len] = '\0';
+	return (len);
+}
+
+/**
+ * custom_getline - reads input from user
+ * @lineptr: buffer to store user input
+ * @n: size of the buffer
+ *
+ * Bytes read past the newline stay in a static buffer of its own,
+ * apart from the one read_line uses, for the next call. The newline is found with memchr and whole chunks are copied
+ * with memcpy; *lineptr grows with realloc.
+ * Return: size of the input read
+ */
+ssize_t custom_getline(char **lineptr, size_t *n)
+{
+	static char buffer[INPUT_BUFFER_SIZE];
+	static size_t buffer_pos = 0;
+	static size_t buffer_size = 0;
+	size_t chars_read = 0, chunk;
+	ssize_t read_size;
+	char *newline, *grown;
+
+	if (lineptr == NULL || n == NULL)
+	{
+		return -1;
+	}
+
+	if (*lineptr == NULL || *n == 0)
+	{
+		*n = MAX_INPUT_LENGTH;
+		*lineptr = realloc(*lineptr, *n);
+		if (*lineptr == NULL)
+		{
+			return -1;
+		}
+	}
+
+	while (1)
+	{
+		if (buffer_pos >= buffer_size)
+		{
+			buffer_pos = 0;
+			buffer_size = 0;
+			read_size = read(STDIN_FILENO, buffer, INPUT_BUFFER_SIZE);
+			if (read_size == 0)
+			{
+				/* End of input */
+				if (chars_read == 0)
+				{
+					return -1;
+				}
+				else
+				{
+					break;
+				}
+			}
+			else if (read_size == -1)
+			{
+				return -1;
+			}
+			buffer_size = read_size;
+		}
+
+		newline = memchr(buffer + buffer_pos, '\n', buffer_size - buffer_pos);
+		if (newline != NULL)
+			chunk = newline - (buffer + buffer_pos) + 1;
+		else
+			chunk = buffer_size - buffer_pos;
+
+		/* Keep room for the chunk and the terminating NUL */
+		if (chars_read + chunk + 1 > *n)
+		{
+			size_t size = *n;
+
+			while (chars_read + chunk + 1 > size)
+				size *= 2;
+			grown = realloc(*lineptr, size);
+			if (grown == NULL)
+			{
+				return -1;
+			}
+			*lineptr = grown;
+			*n = size;
+		}
+
+		memcpy(*lineptr + chars_read, buffer + buffer_pos, chunk);
+		chars_read += chunk;
+		buffer_pos += chunk;
+
+		if (newline != NULL)
+		{
+			break;
+		}
+	}
+
+	(*lineptr)[chars_read] = '\0';
+
+	return chars_read;
+}
@@ -0,0 +1,596 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/syscall.h>
+#include "main.h"
+
+#define JOBS_MIN 16
+#define JOBS_EVENTS 64
+#define JOBS_SIGNAL_TAG UINT64_MAX
+#define JOBS_INPUT_TAG (UINT64_MAX - 1)
+
+/**
+ * struct job - a pipeline running in the background
+ * @id: job number, as shown by jobs and used by wait %N
+ * @pids: processes of the pipeline, 0 once reaped
+ * @pidfds: pidfd watching each process, -1 if there is none
+ * @last_pid: process of the last stage, kept after it is reaped
+ * @count: number of processes
+ * @running: number of processes not reaped yet
+ * @status: exit status of the last process, once it is reaped
+ * @command: text of the pipeline
+ */
+typedef struct job
+{
+	int id;
+	pid_t *pids;
+	int *pidfds;
+	pid_t last_pid;
+	int count;
+	int running;
+	int status;
+	char *command;
+} job_t;
+
+static job_t *jobs;
+static size_t job_count;
+static size_t job_size;
+static size_t jobs_running;
+static int event_fd = -1;
+static int signal_fd = -1;
+static int input_ready;
+static pid_t last_background;
+/* Exit status of the $! job once it was forgotten, -1 while it is not */
+static int last_background_status = -1;
+
+/**
+ * jobs_init - creates the event loop background children are watched by
+ *
+ * The signalfd is created up front, while descriptors are available,
+ * but SIGCHLD is left unblocked: it is discarded and the signalfd
+ * stays silent until watch_sigchld is needed.
+ */
+static void jobs_init(void)
+{
+	struct epoll_event event;
+	sigset_t mask;
+
+	event_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (event_fd == -1)
+	{
+		perror("epoll_create1");
+		exit(EXIT_FAILURE);
+	}
+
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGCHLD);
+	signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+	if (signal_fd == -1)
+	{
+		perror("signalfd");
+		exit(EXIT_FAILURE);
+	}
+	event.events = EPOLLIN;
+	event.data.u64 = JOBS_SIGNAL_TAG;
+	epoll_ctl(event_fd, EPOLL_CTL_ADD, signal_fd, &event);
+}
+
+/**
+ * watch_sigchld - starts delivering SIGCHLD to the signalfd
+ *
+ * Only needed for children that could not get a pidfd, because the
+ * kernel is too old or the descriptor limit was reached. Blocking
+ * SIGCHLD makes it queue on the signalfd; spawn_command clears the
+ * mask again in the children.
+ */
+static void watch_sigchld(void)
+{
+	static int blocked;
+	sigset_t mask;
+
+	if (blocked)
+		return;
+
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGCHLD);
+	sigprocmask(SIG_BLOCK, &mask, NULL);
+	blocked = 1;
+}
+
+/**
+ * watch_child - adds a pidfd for a background process to the loop
+ * @pid: process to watch
+ * @id: job the process belongs to
+ * @stage: position of the process in the job
+ *
+ * The event carries the job and the stage, so an exit is routed to
+ * its job without scanning the table.
+ * Return: the pidfd, -1 if the process is watched through SIGCHLD
+ */
+static int watch_child(pid_t pid, int id, int stage)
+{
+	struct epoll_event event;
+	int fd;
+
+	fd = syscall(SYS_pidfd_open, pid, 0);
+	if (fd == -1)
+	{
+		watch_sigchld();
+		return (-1);
+	}
+	fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+	event.events = EPOLLIN;
+	event.data.u64 = (uint64_t)id << 32 | (uint32_t)stage;
+	if (epoll_ctl(event_fd, EPOLL_CTL_ADD, fd, &event) == -1)
+	{
+		close(fd);
+		watch_sigchld();
+		return (-1);
+	}
+	return (fd);
+}
+
+/**
+ * job_reap_stage - reaps one process of a job if it has finished
+ * @job: job the process belongs to
+ * @stage: position of the process in the job
+ * @block: 1 to wait until the process has finished
+ *
+ * Only the job's own pids are waited for, so children the shell is
+ * waiting for in the foreground are never reaped from under it.
+ */
+static void job_reap_stage(job_t *job, int stage, int block)
+{
+	int status;
+	pid_t pid;
+
+	if (job->pids[stage] == 0)
+		return;
+	do {
+		pid = waitpid(job->pids[stage], &status, block ? 0 : WNOHANG);
+	} while (pid == -1 && errno == EINTR);
+	if (pid == 0)
+		return;
+
+	trace_child(job->pids[stage], 0);
+	if (pid == job->pids[stage] && stage == job->count - 1)
+		job->status = WIFSIGNALED(status) ? 128 + WTERMSIG(status)
+			: WEXITSTATUS(status);
+	job->pids[stage] = 0;
+	if (--job->running == 0)
+		jobs_running--;
+	if (job->pidfds[stage] != -1)
+	{
+		close(job->pidfds[stage]);
+		job->pidfds[stage] = -1;
+	}
+}
+
+/**
+ * job_update - reaps the processes of a job that have finished
+ * @job: job to update
+ * @block: 1 to wait until the whole job has finished
+ */
+static void job_update(job_t *job, int block)
+{
+	int i;
+
+	for (i = 0; i < job->count; i++)
+		job_reap_stage(job, i, block);
+}
+
+/**
+ * job_add - records a pipeline started in the background
+ * @pids: processes of the pipeline
+ * @count: number of processes
+ * @command: text of the pipeline
+ * Return: job number
+ */
+int job_add(pid_t *pids, int count, const char *command)
+{
+	job_t *job, *grown;
+	int i, unwatched = 0;
+
+	if (event_fd == -1)
+		jobs_init();
+
+	if (job_count == job_size)
+	{
+		job_size = job_size ? job_size * 2 : JOBS_MIN;
+		grown = realloc(jobs, job_size * sizeof(*jobs));
+		if (grown == NULL)
+		{
+			perror("malloc");
+			exit(EXIT_FAILURE);
+		}
+		jobs = grown;
+	}
+
+	job = &jobs[job_count];
+	job->id = job_count > 0 ? jobs[job_count - 1].id + 1 : 1;
+	job->pids = malloc(count * sizeof(*pids));
+	job->pidfds = malloc(count * sizeof(*job->pidfds));
+	job->command = strdup(command);
+	if (job->pids == NULL || job->pidfds == NULL || job->command == NULL)
+	{
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+	memcpy(job->pids, pids, count * sizeof(*pids));
+	job->last_pid = pids[count - 1];
+	job->count = count;
+	job->running = count;
+	job->status = 0;
+	job_count++;
+	jobs_running++;
+
+	for (i = 0; i < count; i++)
+	{
+		job->pidfds[i] = watch_child(pids[i], job->id, i);
+		unwatched |= job->pidfds[i] == -1;
+	}
+	/* A process that exited before SIGCHLD was blocked sent no event */
+	if (unwatched)
+		job_update(job, 0);
+
+	last_background = pids[count - 1];
+	last_background_status = -1;
+	if (is_interactive())
+	{
+		buffer_write("[", 1);
+		buffer_put_number(job->id);
+		buffer_write("] ", 2);
+		buffer_put_number(last_background);
+		buffer_write("\n", 1);
+	}
+	return (job->id);
+}
+
+/**
+ * jobs_last_pid - returns the pid of the last background command ($!)
+ * Return: the pid, 0 if nothing was started in the background
+ */
+pid_t jobs_last_pid(void)
+{
+	return (last_background);
+}
+
+/**
+ * job_by_id - finds a job from the tag of an event
+ * @id: job number
+ *
+ * Job numbers only grow along the table, so it is searched by halves.
+ * Return: the job, NULL if it was already removed
+ */
+static job_t *job_by_id(int id)
+{
+	size_t low = 0, high = job_count, middle;
+
+	while (low < high)
+	{
+		middle = low + (high - low) / 2;
+		if (jobs[middle].id == id)
+			return (&jobs[middle]);
+		if (jobs[middle].id < id)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return (NULL);
+}
+
+/**
+ * jobs_poll - waits for events and handles them
+ * @timeout: milliseconds to wait, -1 forever, 0 not at all
+ *
+ * A pidfd event reaps exactly the process it names, so handling N
+ * exits costs N events however many children are running. SIGCHLD,
+ * for unwatched processes, falls back to checking every job.
+ * Return: number of events handled
+ */
+static int jobs_poll(int timeout)
+{
+	struct epoll_event events[JOBS_EVENTS];
+	struct signalfd_siginfo info;
+	uint64_t tag;
+	job_t *job;
+	size_t j;
+	int count, i;
+
+	count = epoll_wait(event_fd, events, JOBS_EVENTS, timeout);
+	if (count == -1)
+	{
+		if (errno != EINTR)
+			perror("epoll_wait");
+		return (0);
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		tag = events[i].data.u64;
+		if (tag == JOBS_INPUT_TAG)
+		{
+			input_ready = 1;
+		}
+		else if (tag == JOBS_SIGNAL_TAG)
+		{
+			while (read(signal_fd, &info, sizeof(info)) > 0)
+				;
+			for (j = 0; j < job_count; j++)
+				job_update(&jobs[j], 0);
+		}
+		else
+		{
+			job = job_by_id(tag >> 32);
+			if (job != NULL)
+				job_reap_stage(job, tag & 0xffffffff, 0);
+		}
+	}
+	return (count);
+}
+
+/**
+ * job_remove - forgets a job
+ * @index: position of the job in the table
+ */
+static void job_remove(size_t index)
+{
+	int i;
+
+	for (i = 0; i < jobs[index].count; i++)
+	{
+		if (jobs[index].pidfds[i] != -1)
+			close(jobs[index].pidfds[i]);
+	}
+	free(jobs[index].pids);
+	free(jobs[index].pidfds);
+	free(jobs[index].command);
+	memmove(&jobs[index], &jobs[index + 1],
+		(job_count - index - 1) * sizeof(*jobs));
+	job_count--;
+}
+
+/**
+ * print_job - prints the state of a job, as the jobs builtin does
+ * @job: job to print
+ */
+static void print_job(job_t *job)
+{
+	buffer_write("[", 1);
+	buffer_put_number(job->id);
+	buffer_write("]  ", 3);
+	if (job->running > 0)
+	{
+		buffer_puts("Running");
+	}
+	else if (job->status == 0)
+	{
+		buffer_puts("Done");
+	}
+	else
+	{
+		buffer_puts("Exit ");
+		buffer_put_number(job->status);
+	}
+	buffer_write("\t", 1);
+	buffer_puts(job->command);
+	buffer_write("\n", 1);
+}
+
+/**
+ * report_jobs - forgets finished jobs, reporting them when interactive
+ *
+ * A script starting many background commands would otherwise keep
+ * every finished one in the table. The status of the $! job is kept
+ * for a later wait $!.
+ */
+static void report_jobs(void)
+{
+	size_t i;
+
+	for (i = job_count; i > 0; i--)
+	{
+		if (jobs[i - 1].running == 0)
+		{
+			if (is_interactive())
+				print_job(&jobs[i - 1]);
+			if (jobs[i - 1].last_pid == last_background)
+				last_background_status = jobs[i - 1].status;
+			job_remove(i - 1);
+		}
+	}
+}
+
+/**
+ * jobs_reap - reaps background processes that have finished
+ *
+ * Called at every command boundary. Only the events already pending
+ * are collected, so finished jobs never linger as zombies.
+ */
+void jobs_reap(void)
+{
+	if (event_fd == -1)
+		return;
+
+	while (jobs_poll(0) == JOBS_EVENTS)
+		;
+	report_jobs();
+}
+
+/**
+ * jobs_wait_input - waits for a descriptor to be readable
+ * @fd: descriptor, typically standard input
+ *
+ * Background processes keep being reaped, and reported when the shell
+ * is interactive, while the shell sits waiting for its next line.
+ */
+void jobs_wait_input(int fd)
+{
+	struct epoll_event event;
+
+	if (event_fd == -1 || job_count == 0)
+		return;
+
+	event.events = EPOLLIN;
+	event.data.u64 = JOBS_INPUT_TAG;
+	/* Regular files cannot be watched, and are always readable */
+	if (epoll_ctl(event_fd, EPOLL_CTL_ADD, fd, &event) == -1)
+		return;
+
+	input_ready = 0;
+	while (!input_ready)
+	{
+		jobs_poll(-1);
+		report_jobs();
+		buffer_flush();
+	}
+	epoll_ctl(event_fd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+/**
+ * jobs_builtin - implements the jobs builtin
+ * @argc: number of arguments
+ * @argv: command arguments
+ * @io: descriptors of the builtin
+ *
+ * Jobs reported as finished are removed from the table.
+ * Return: always 0
+ */
+int jobs_builtin(int argc, char **argv, builtin_io_t *io)
+{
+	size_t i;
+
+	(void)argc;
+	(void)argv;
+	(void)io;
+
+	for (i = 0; i < job_count; i++)
+	{
+		job_update(&jobs[i], 0);
+		print_job(&jobs[i]);
+	}
+	for (i = job_count; i > 0; i--)
+	{
+		if (jobs[i - 1].running == 0)
+			job_remove(i - 1);
+	}
+	return (0);
+}
+
+/**
+ * wait_next - waits for the next job to finish (wait -n)
+ * Return: exit status of the job, 127 if there are no jobs
+ */
+static int wait_next(void)
+{
+	size_t i;
+	int status;
+
+	while (job_count > 0)
+	{
+		/* Sleep until a child exits, unless a job is already done */
+		if (jobs_running == job_count)
+		{
+			jobs_poll(-1);
+			continue;
+		}
+		for (i = 0; i < job_count; i++)
+		{
+			if (jobs[i].running == 0)
+			{
+				status = jobs[i].status;
+				job_remove(i);
+				return (status);
+			}
+		}
+	}
+	return (127);
+}
+
+/**
+ * find_job - looks up a job by %N or by the pid of one of its processes
+ * @operand: operand of wait
+ * Return: position of the job in the table, -1 if there is none
+ */
+static long find_job(const char *operand)
+{
+	long number = atol(operand + (operand[0] == '%'));
+	size_t i;
+	int j;
+
+	if (number <= 0)
+		return (-1);
+
+	for (i = 0; i < job_count; i++)
+	{
+		if (operand[0] == '%')
+		{
+			if (jobs[i].id == number)
+				return (i);
+			continue;
+		}
+		if (jobs[i].last_pid == number)
+			return (i);
+		for (j = 0; j < jobs[i].count; j++)
+		{
+			if (jobs[i].pids[j] == number)
+				return (i);
+		}
+	}
+	return (-1);
+}
+
+/**
+ * wait_builtin - implements the wait builtin
+ * @argc: number of arguments
+ * @argv: command arguments
+ * @io: descriptors of the builtin
+ *
+ * Without operands every job is waited for; with -n, only the next
+ * one to finish; otherwise the jobs named by pid or %N.
+ * Return: exit status of the last job waited for, 127 if unknown
+ */
+int wait_builtin(int argc, char **argv, builtin_io_t *io)
+{
+	long index;
+	int i, status = 0;
+
+	if (argc == 1)
+	{
+		while (jobs_running > 0)
+			jobs_poll(-1);
+		while (job_count > 0)
+			job_remove(job_count - 1);
+		return (0);
+	}
+	if (strcmp(argv[1], "-n") == 0)
+		return (wait_next());
+
+	for (i = 1; i < argc; i++)
+	{
+		index = find_job(argv[i]);
+		if (index == -1 && last_background_status != -1 &&
+		    argv[i][0] != '%' && atol(argv[i]) == last_background)
+		{
+			status = last_background_status;
+			continue;
+		}
+		if (index == -1)
+		{
+			write(io->err, "wait: no such job: ", 19);
+			write(io->err, argv[i], strlen(argv[i]));
+			write(io->err, "\n", 1);
+			status = 127;
+			continue;
+		}
+		job_update(&jobs[index], 1);
+		status = jobs[index].status;
+		job_remove(index);
+	}
+	return (status);
+}
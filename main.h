@@ -7,19 +7,312 @@
 #include <unistd.h>
 #include <sys/wait.h>
 #include <sys/types.h>
+#include <sys/resource.h>
 
 #define MAX_INPUT_LENGTH 1024
 #define MAX_NUM_ARGS 128
 
+#define SPAWN_FORK 0
+#define SPAWN_VFORK 1
+#define SPAWN_CLONE 2
+#define SPAWN_POSIX 3
+
+/**
+ * struct line_reader - reads a script one line at a time
+ * @fd: descriptor of the script
+ * @data: mapped file, or the buffer of a streamed one
+ * @size: number of valid bytes in @data
+ * @pos: offset of the first unread byte
+ * @capacity: size of the streaming buffer, 0 when mapped
+ * @mapped: 1 if @data is a read-only mapping of the whole file
+ * @eof: 1 once no more data can be read
+ */
+typedef struct line_reader
+{
+	int fd;
+	char *data;
+	size_t size;
+	size_t pos;
+	size_t capacity;
+	int mapped;
+	int eof;
+} line_reader_t;
+
+#define PLAN_SEQ 0
+#define PLAN_AND 1
+#define PLAN_OR 2
+#define PLAN_PIPE 3
+#define PLAN_BACKGROUND 4
+
+/**
+ * struct plan_word - one word of a compiled command
+ * @text: literal text, or the variable name of an expansion slot
+ * @expand: 0 for literal text, 1 for an expansion slot, 2 for text
+ * with $NAME references inside, where a backslash escapes the next
+ * character
+ * @quoted: 1 if the word was written with quotes, so it stays a word
+ * even when it expands to nothing
+ */
+typedef struct plan_word
+{
+	char *text;
+	int expand;
+	int quoted;
+} plan_word_t;
+
+#define REDIRECT_IN 0
+#define REDIRECT_OUT 1
+#define REDIRECT_APPEND 2
+
+/**
+ * struct plan_redirect - one redirection of a compiled command
+ * @type: REDIRECT_IN (<), REDIRECT_OUT (>) or REDIRECT_APPEND (>>)
+ * @target: file name
+ */
+typedef struct plan_redirect
+{
+	int type;
+	plan_word_t target;
+} plan_redirect_t;
+
+/**
+ * struct plan_command - one command of a compiled line
+ * @words: argument template
+ * @word_count: number of words
+ * @assign_count: number of leading NAME=value words
+ * @redirects: redirections, applied in order
+ * @redirect_count: number of redirections
+ * @next_op: PLAN_* edge leading to the next command
+ */
+typedef struct plan_command
+{
+	plan_word_t *words;
+	int word_count;
+	int assign_count;
+	plan_redirect_t *redirects;
+	int redirect_count;
+	int next_op;
+} plan_command_t;
+
+/**
+ * struct plan - immutable execution plan of one line
+ * @source: text the plan was compiled from
+ * @source_len: length of @source
+ * @hash: hash of @source
+ * @commands: compiled commands, in order
+ * @command_count: number of commands
+ * @shell: 1 if the line uses syntax left to /bin/sh, which then runs
+ * it whole unless it would change the state of the shell
+ * @cached: 1 if the plan is owned by the plan cache
+ * @next: next plan in the same cache bucket
+ */
+typedef struct plan
+{
+	char *source;
+	size_t source_len;
+	unsigned long hash;
+	plan_command_t *commands;
+	int command_count;
+	int shell;
+	int cached;
+	struct plan *next;
+} plan_t;
+
+/**
+ * struct alias - an alias and the text it stands for
+ * @name: interned alias name
+ * @value: interned replacement text
+ * @tokens: @value split into interned words
+ * @token_count: number of tokens
+ */
+typedef struct alias
+{
+	const char *name;
+	const char *value;
+	const char **tokens;
+	int token_count;
+} alias_t;
+
+/**
+ * struct env_saved - a variable as it was before env_push
+ * @name: variable name, NULL at the end of the list
+ * @value: previous value, NULL if the variable was not set
+ * @exported: previous exported flag
+ */
+typedef struct env_saved
+{
+	char *name;
+	char *value;
+	int exported;
+} env_saved_t;
+
+/**
+ * struct builtin_io - descriptors a builtin reads and writes
+ * @in: standard input of the builtin
+ * @out: standard output, where the shared output buffer is written
+ * @err: standard error
+ */
+typedef struct builtin_io
+{
+	int in;
+	int out;
+	int err;
+} builtin_io_t;
+
+/**
+ * struct builtin - an entry of the builtin registry
+ * @name: name of the builtin
+ * @handler: function implementing it
+ */
+typedef struct builtin
+{
+	const char *name;
+	int (*handler)(int argc, char **argv, builtin_io_t *io);
+} builtin_t;
+
+/**
+ * struct deadline - time limit of a foreground command
+ * @group: process group signalled when the deadline passes, 0 for none
+ * @expires: CLOCK_MONOTONIC time of the deadline in ns, 0 if unarmed
+ * @kill_after: delay between @signal and SIGKILL in ns, 0 for none
+ * @signal: signal sent first
+ * @expired: 1 once the deadline has passed
+ */
+typedef struct deadline
+{
+	pid_t group;
+	long long expires;
+	long long kill_after;
+	int signal;
+	int expired;
+} deadline_t;
+
+#define STAT_PARSE 0
+#define STAT_LOOKUP 1
+#define STAT_SPAWN 2
+#define STAT_WAIT 3
+#define STAT_BUILTIN 4
+#define STAT_EXPAND 5
+#define STAT_PHASES 6
+
+#define STAT_FORKS 0
+#define STAT_EXECS 1
+#define STAT_ENOENT 2
+#define STAT_BUILTINS 3
+#define STAT_COUNTERS 4
+
+extern int stats_enabled;
+extern int trace_enabled;
+extern unsigned long stat_counters[STAT_COUNTERS];
+
+/*
+ * STAT_START - timestamps the start of a phase, 0 when neither the
+ * histograms nor the trace are on; STAT_RECORD then costs a single
+ * test. The STAT_COUNT counters are kept either way, for the price of
+ * an increment.
+ */
+#define STAT_START() (stats_enabled || trace_enabled ? monotonic_ns() : 0)
+#define STAT_RECORD(phase, start) \
+	do { \
+		if (start) \
+			stat_record(phase, start); \
+	} while (0)
+#define STAT_COUNT(counter) (stat_counters[counter]++)
+
 void print_prompt(void);
 ssize_t read_input(char *input);
 void print_environment(void);
-void execute_command(char *command);
 void execute_command(char **args);
 void wait_for_child(pid_t pid, int *status);
+void wait_for_child_usage(pid_t pid, int *status, struct rusage *usage);
 void handle_command_execution(char **args);
-void parse_command(char *input, char **args);
+char **parse_command(char *input);
 int check_command_exists(char *command);
 ssize_t read_command(char *input);
+int get_spawn_backend(void);
+pid_t spawn_command(char **args, char **envp, int in, int out);
+void spawn_process_group(pid_t group);
+char *find_command(char *command);
+char *find_command_in(char *command, const char *path);
+void hash_reset(void);
+void print_hash_table(void);
+int hash_builtin(int argc, char **argv, builtin_io_t *io);
+void buffer_write(const char *data, size_t len);
+void buffer_puts(const char *str);
+void buffer_put_number(long n);
+void buffer_flush(void);
+int buffer_set_fd(int fd);
+void buffer_use_vmsplice(void);
+void *arena_alloc(size_t size);
+char *arena_strndup(const char *str, size_t len);
+void arena_reset(void);
+int reader_open(line_reader_t *reader, const char *filename);
+int reader_next(line_reader_t *reader, const char **line, size_t *len);
+void reader_close(line_reader_t *reader);
+int is_interactive(void);
+ssize_t read_line(char *input, size_t size);
+ssize_t read_long_line(char **input, size_t *size);
+ssize_t custom_getline(char **lineptr, size_t *n);
+int count_args(char *input);
+char **split_words(char *input);
+char **strtok_words(char *input);
+plan_t *plan_compile(const char *line, size_t len);
+void plan_release(plan_t *plan);
+int plan_execute(plan_t *plan);
+const char *intern_string(const char *str, size_t len);
+size_t interned_length(const char *str);
+alias_t *find_alias(const char *name);
+void add_alias(char *name, char *value);
+void print_alias_entry(alias_t *alias);
+void print_aliases(void);
+void print_alias(char **alias_names, int count);
+char **expand_alias(char **args);
+char *env_get(const char *name);
+int env_set(const char *name, const char *value, int export);
+int env_unset(const char *name);
+char **env_environ(void);
+size_t assignment_name_length(const char *word);
+int env_assign(const char *word);
+char **env_overlay(char **assignments, int count);
+env_saved_t *env_push(char **assignments);
+void env_pop(env_saved_t *saved);
+void alias_expansion_stats(unsigned long *count, unsigned long *ns);
+const builtin_t *find_builtin(const char *name);
+const char *current_directory(void);
+int change_directory(const char *path, builtin_io_t *io);
+int cd_builtin(int argc, char **argv, builtin_io_t *io);
+int pushd_builtin(int argc, char **argv, builtin_io_t *io);
+int popd_builtin(int argc, char **argv, builtin_io_t *io);
+int dirs_builtin(int argc, char **argv, builtin_io_t *io);
+int job_add(pid_t *pids, int count, const char *command);
+pid_t jobs_last_pid(void);
+void jobs_reap(void);
+void jobs_wait_input(int fd);
+int jobs_builtin(int argc, char **argv, builtin_io_t *io);
+int wait_builtin(int argc, char **argv, builtin_io_t *io);
+long long monotonic_ns(void);
+int parse_duration(const char *text, long long *ns);
+int parse_signal(const char *text);
+void deadline_default(deadline_t *deadline);
+void deadline_init(deadline_t *deadline, long long timeout, int signal,
+		   long long kill_after);
+void deadline_terminal(pid_t group);
+void deadline_wait(deadline_t *deadline, pid_t pid, int *status,
+		   struct rusage *usage);
+int timeout_builtin(int argc, char **argv, builtin_io_t *io);
+void usage_add(struct rusage *total, const struct rusage *usage);
+void usage_since(struct rusage *total, const struct rusage *before);
+void usage_report(int fd, long long wall, const struct rusage *usage,
+		  int status, int json);
+void stats_init(void);
+void stat_record(int phase, long long start);
+int shellstat_builtin(int argc, char **argv, builtin_io_t *io);
+void trace_init(void);
+int trace_start(void);
+void trace_finish(void);
+void trace_command(const char *text, size_t len);
+void trace_phase(int phase, long long start, long long end);
+void trace_child(pid_t pid, int begin);
+int run_builtin(const builtin_t *builtin, char **args, builtin_io_t *io);
 
 #endif /* MAIN_H */
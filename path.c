@@ -13,65 +13,20 @@ extern char **environ;
 
 void print_prompt(void)
 {
-	write(STDOUT_FILENO, "$ ", 2);
+	if (is_interactive())
+		write(STDOUT_FILENO, "$ ", 2);
 }
 
 ssize_t read_command(char *input)
 {
-	ssize_t read_size = read(STDIN_FILENO, input, MAX_INPUT_LENGTH);
-
-	if (read_size == -1)
-	{
-		perror("read");
-		exit(EXIT_FAILURE);
-	}
-	else if (read_size == 0)
-	{
-		write(STDOUT_FILENO, "\n", 1);
-		exit(EXIT_SUCCESS);
-	}
-
-	/* Remove newline character from end of command */
-	input[read_size - 1] = '\0';
+	ssize_t read_size = read_line(input, MAX_INPUT_LENGTH);
 
 	return read_size;
 }
 
-void parse_command(char *input, char **args)
-{
-	char *arg = strtok(input, " ");
-	int i = 0;
-
-	while (arg != NULL && i < MAX_NUM_ARGS - 1)
-	{
-		args[i++] = arg;
-		arg = strtok(NULL, " ");
-	}
-	args[i] = NULL;
-}
-
-int check_command_exists(char *command)
-{
-	if (access(command, F_OK) == -1)
-	{
-		write(STDERR_FILENO, "Command not found\n", 18);
-		return 0;
-	}
-	return 1;
-}
-
-void execute_command(char **args)
-{
-	execve(args[0], args, environ);
-	perror("execve");
-	_exit(EXIT_FAILURE);
-}
-
-void wait_for_child(pid_t pid, int *status)
+char **parse_command(char *input)
 {
-	do {
-		waitpid(pid, status, WUNTRACED);
-	} while (!WIFEXITED(*status) && !WIFSIGNALED(*status));
+	return (strtok_words(input));
 }
 
 void handle_command_execution(char **args)
@@ -80,20 +35,14 @@ void handle_command_execution(char **args)
 	int status;
 
 	/* Create child process */
-	pid = fork();
+	pid = spawn_command(args, NULL, -1, -1);
 
 	if (pid == -1)
 	{
 		perror("fork");
 		exit(EXIT_FAILURE);
 	}
-	else if (pid == 0)
-	{
-		/* Child process */
-		/* Execute command */
-		execute_command(args);
-	}
-	else
+	else if (pid > 0)
 	{
 		/* Parent process */
 		/* Wait for child process to complete */
@@ -104,10 +53,15 @@ void handle_command_execution(char **args)
 int main(int argc, char **argv)
 {
 	char input[MAX_INPUT_LENGTH];
-	char *args[MAX_NUM_ARGS];
+	char **args;
+	char *command;
+	const builtin_t *builtin;
 
 	while (1)
 	{
+		/* Release the previous command line */
+		arena_reset();
+
 		/* Print prompt */
 		print_prompt();
 
@@ -115,13 +69,27 @@ int main(int argc, char **argv)
 		ssize_t read_size = read_command(input);
 
 		/* Parse command into arguments */
-		parse_command(input, args);
+		args = parse_command(input);
+
+		if (args[0] == NULL)
+			continue;
+
+		/* Builtins are looked up before PATH */
+		builtin = find_builtin(args[0]);
+		if (builtin != NULL)
+		{
+			run_builtin(builtin, args, NULL);
+			continue;
+		}
 
 		/* Check if command exists in PATH */
-		if (!check_command_exists(args[0]))
+		command = find_command(args[0]);
+		if (command == NULL)
 		{
+			write(STDERR_FILENO, "Command not found\n", 18);
 			continue;
 		}
+		args[0] = command;
 
 		/* Handle command execution */
 		handle_command_execution(args);
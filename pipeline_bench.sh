@@ -0,0 +1,43 @@
+#!/bin/bash
+
+# Measure pipeline throughput of the shell
+# Usage: ./pipeline_bench.sh ./hsh [GiB]
+#
+# Pushes the given amount of data (default 4 GiB) through
+# producer | cat | consumer, once with default pipe buffers and once
+# with SHELL_PIPE_SIZE set to 1 MiB. The builtin case has the alias
+# builtin produce the data, 1 MiB per line, so its output goes through
+# vmsplice.
+
+shell=${1:?usage: $0 SHELL [GiB]}
+gib=${2:-4}
+bytes=$((gib * 1024 * 1024 * 1024))
+script=$(mktemp)
+builtin=$(mktemp)
+trap 'rm -f "$script" "$builtin"' EXIT
+
+echo "head -c $bytes /dev/zero | cat | wc -c" > "$script"
+
+{
+	printf 'alias big=%s\n' "$(head -c 1048570 /dev/zero | tr '\0' x)"
+	for ((i = 0; i < gib * 1024; i++)); do
+		echo 'alias | cat | wc -c'
+	done
+} > "$builtin"
+
+run()
+{
+	local label=$1 file=$2 start end ns
+
+	shift 2
+	start=$(date +%s%N)
+	env "$@" "$shell" "$file" > /dev/null
+	end=$(date +%s%N)
+	ns=$((end - start))
+	echo "$label: $gib GiB in $((ns / 1000000)) ms," \
+		"$((bytes * 1000 / ns)) MB/s"
+}
+
+run SHELL_PIPE_SIZE= "$script" SHELL_PIPE_SIZE=
+run SHELL_PIPE_SIZE=1048576 "$script" SHELL_PIPE_SIZE=1048576
+run builtin "$builtin" SHELL_PIPE_SIZE=
@@ -0,0 +1,1379 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include "main.h"
+
+#define PLAN_CACHE_SIZE 256
+#define PLAN_CACHE_LIMIT 4096
+
+static plan_t *plan_cache[PLAN_CACHE_SIZE];
+static int plan_cache_count;
+static int last_status;
+static struct rusage *plan_usage;
+
+/**
+ * plan_alloc - allocates zeroed memory for a plan
+ * @size: number of bytes
+ * Return: pointer to the memory
+ */
+static void *plan_alloc(size_t size)
+{
+	void *memory = calloc(1, size);
+
+	if (memory == NULL)
+	{
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+	return (memory);
+}
+
+/**
+ * plan_hash - hashes the source text of a line (FNV-1a)
+ * @line: line to hash
+ * @len: length of the line
+ * Return: hash value
+ */
+static unsigned long plan_hash(const char *line, size_t len)
+{
+	unsigned long hash = 2166136261UL;
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		hash = (hash ^ (unsigned char)line[i]) * 16777619UL;
+	return (hash);
+}
+
+/**
+ * plan_operator - recognises a control operator
+ * @p: current position in the line
+ * @end: end of the line
+ * @op: set to the PLAN_* edge of the operator
+ * Return: length of the operator, 0 if there is none at @p
+ */
+static int plan_operator(const char *p, const char *end, int *op)
+{
+	if (*p == ';')
+	{
+		*op = PLAN_SEQ;
+		return (1);
+	}
+	if (p + 1 < end && p[0] == '&' && p[1] == '&')
+	{
+		*op = PLAN_AND;
+		return (2);
+	}
+	if (*p == '&')
+	{
+		*op = PLAN_BACKGROUND;
+		return (1);
+	}
+	if (p + 1 < end && p[0] == '|' && p[1] == '|')
+	{
+		*op = PLAN_OR;
+		return (2);
+	}
+	if (*p == '|')
+	{
+		*op = PLAN_PIPE;
+		return (1);
+	}
+	return (0);
+}
+
+/**
+ * plan_add_command - appends an empty command to a plan
+ * @plan: plan being compiled
+ * Return: the new command
+ */
+static plan_command_t *plan_add_command(plan_t *plan)
+{
+	plan_command_t *commands;
+
+	commands = realloc(plan->commands,
+			   (plan->command_count + 1) * sizeof(*commands));
+	if (commands == NULL)
+	{
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+	plan->commands = commands;
+	memset(&commands[plan->command_count], 0, sizeof(*commands));
+	commands[plan->command_count].next_op = PLAN_SEQ;
+	return (&commands[plan->command_count++]);
+}
+
+/**
+ * plan_is_name - tells whether a word is $NAME, $?, $$ or $!
+ * @p: start of the word, at its $
+ * @end: end of the word
+ * Return: 1 if the word is a whole expansion slot, 0 otherwise
+ */
+static int plan_is_name(const char *p, const char *end)
+{
+	if (++p == end)
+		return (1);
+	if (p + 1 == end && (*p == '?' || *p == '$' || *p == '!'))
+		return (1);
+	if (*p >= '0' && *p <= '9')
+		return (0);
+	for (; p < end; p++)
+	{
+		if (!(*p == '_' || (*p >= 'A' && *p <= 'Z') ||
+		      (*p >= 'a' && *p <= 'z') || (*p >= '0' && *p <= '9')))
+			return (0);
+	}
+	return (1);
+}
+
+/**
+ * plan_name_end - finds the end of the variable named after a $
+ * @p: character after the $
+ * @end: end of the word
+ * Return: first character after the name, @p if there is none
+ */
+static const char *plan_name_end(const char *p, const char *end)
+{
+	const char *start = p;
+
+	if (p < end && (*p == '?' || *p == '$' || *p == '!'))
+		return (p + 1);
+	if (p < end && *p >= '0' && *p <= '9')
+		return (p);
+	while (p < end && (*p == '_' || (*p >= 'A' && *p <= 'Z') ||
+			   (*p >= 'a' && *p <= 'z') ||
+			   (p > start && *p >= '0' && *p <= '9')))
+		p++;
+	return (p);
+}
+
+/**
+ * plan_is_reference - tells whether a $ inside a word is one the
+ * templates know
+ * @p: the $
+ * @end: end of the word
+ * Return: 1 for $NAME, ${NAME}, $?, $$ and $!, 0 otherwise
+ */
+static int plan_is_reference(const char *p, const char *end)
+{
+	const char *name;
+
+	if (p + 1 < end && p[1] == '{')
+	{
+		name = plan_name_end(p + 2, end);
+		return (name > p + 2 && name < end && *name == '}' &&
+			(p[2] < '0' || p[2] > '9'));
+	}
+	return (plan_name_end(p + 1, end) > p + 1);
+}
+
+/**
+ * plan_assignment_length - recognises a NAME=value word in the source
+ * @word: start of the word
+ * @end: end of the word
+ *
+ * Unlike assignment_name_length, the word needs no NUL and a quoted
+ * name is not one.
+ * Return: length of NAME, 0 if the word is not an assignment
+ */
+static size_t plan_assignment_length(const char *word, const char *end)
+{
+	const char *p = word;
+
+	if (p == end || !(*p == '_' || (*p >= 'A' && *p <= 'Z') ||
+			  (*p >= 'a' && *p <= 'z')))
+		return (0);
+	while (p < end && (*p == '_' || (*p >= 'A' && *p <= 'Z') ||
+			   (*p >= 'a' && *p <= 'z') || (*p >= '0' && *p <= '9')))
+		p++;
+	return (p < end && *p == '=' ? (size_t)(p - word) : 0);
+}
+
+/**
+ * plan_tilde - classifies an unquoted ~
+ * @word: start of the word
+ * @p: the ~
+ * @end: end of the word
+ *
+ * A ~ starts a tilde prefix at the start of a word or of the value of
+ * an assignment.
+ * Return: 1 for ~ or ~/ (the home directory), -1 for ~user, 0 when
+ * the ~ is an ordinary character
+ */
+static int plan_tilde(const char *word, const char *p, const char *end)
+{
+	size_t name = plan_assignment_length(word, end);
+
+	if (*p != '~' || (p != word && (name == 0 || p != word + name + 1)))
+		return (0);
+	return (p + 1 == end || p[1] == '/' ? 1 : -1);
+}
+
+/**
+ * plan_skip_quoted - skips a quoted part of a word
+ * @p: the opening quote or backtick, or the $ of a $(
+ * @end: end of the line
+ *
+ * A backslash escapes the next character except between single
+ * quotes; parentheses nest inside $(...).
+ * Return: first character after the closing quote, @end if it is
+ * missing
+ */
+static const char *plan_skip_quoted(const char *p, const char *end)
+{
+	char close = *p == '$' ? ')' : *p;
+	int depth = 1;
+
+	p += *p == '$' ? 2 : 1;
+	for (; p < end; p++)
+	{
+		if (*p == '\\' && close != '\'' && p + 1 < end)
+			p++;
+		else if (close == ')' && *p == '(')
+			depth++;
+		else if (*p == close && --depth == 0)
+			return (p + 1);
+	}
+	return (end);
+}
+
+/**
+ * plan_word_end - finds the end of a word
+ * @p: start of the word
+ * @end: end of the line
+ *
+ * Blanks and operators inside quotes, after a backslash or inside a
+ * command substitution belong to the word.
+ * Return: first character after the word
+ */
+static const char *plan_word_end(const char *p, const char *end)
+{
+	int op;
+
+	while (p < end && *p != ' ' && *p != '\t' && *p != '\r' &&
+	       *p != '<' && *p != '>' && plan_operator(p, end, &op) == 0)
+	{
+		if (*p == '\\' && p + 1 < end)
+			p += 2;
+		else if (*p == '\'' || *p == '"' || *p == '`' ||
+			 (*p == '$' && p + 1 < end && p[1] == '('))
+			p = plan_skip_quoted(p, end);
+		else
+			p++;
+	}
+	return (p);
+}
+
+/**
+ * plan_unescape - turns a template without references into its text
+ * @text: template, rewritten in place
+ */
+static void plan_unescape(char *text)
+{
+	char *out = text;
+
+	for (; *text != '\0'; text++)
+	{
+		if (*text == '\\' && text[1] != '\0')
+			text++;
+		*out++ = *text;
+	}
+	*out = '\0';
+}
+
+/**
+ * plan_set_word - fills in a word template
+ * @word: word to fill in
+ * @text: start of the word, as written in the source
+ * @len: length of the word
+ *
+ * Words such as $NAME, $? and $$ become expansion slots that are
+ * filled in each time the plan runs. Quotes and backslashes are
+ * removed here, once: what they protected is kept literally, escaped
+ * with a backslash in case the word is a template. A word with $NAME
+ * or ${NAME} inside, such as "$HOME/bin" or X=$Y, keeps its text as
+ * a template; an unquoted ~ becomes ${HOME}.
+ */
+static void plan_set_word(plan_word_t *word, const char *text, size_t len)
+{
+	const char *p, *name, *end = text + len;
+	char *out, quote = 0;
+	size_t n = 0, ref;
+	int brace;
+
+	word->expand = 0;
+	word->quoted = 0;
+	if (len > 1 && text[0] == '$' && plan_is_name(text, end))
+	{
+		word->expand = 1;
+		word->text = plan_alloc(len);
+		memcpy(word->text, text + 1, len - 1);
+		return;
+	}
+
+	/* Escapes at most double the text; ~ grows into ${HOME} */
+	out = plan_alloc(2 * len + sizeof("${HOME}"));
+	for (p = text; p < end; p++)
+	{
+		if ((*p == '\'' || *p == '"') && (quote == 0 || quote == *p))
+		{
+			quote = quote == 0 ? *p : 0;
+			word->quoted = 1;
+		}
+		else if (*p == '\\' && p + 1 < end && (quote == 0 ||
+			 (quote == '"' && strchr("$`\"\\", p[1]) != NULL)))
+		{
+			out[n++] = '\\';
+			out[n++] = *++p;
+		}
+		else if (*p == '$' && quote != '\'' && plan_is_reference(p, end))
+		{
+			/* Braces keep "$X"y from reading as $Xy */
+			brace = p[1] == '{';
+			name = p + 1 + brace;
+			ref = plan_name_end(name, end) - name;
+			out[n++] = '$';
+			out[n++] = '{';
+			memcpy(out + n, name, ref);
+			n += ref;
+			out[n++] = '}';
+			p = name + ref + brace - 1;
+			word->expand = 2;
+		}
+		else if (quote == 0 && plan_tilde(text, p, end) == 1)
+		{
+			memcpy(out + n, "${HOME}", 7);
+			n += 7;
+			word->expand = 2;
+		}
+		else
+		{
+			if (*p == '$' || *p == '\\')
+				out[n++] = '\\';
+			out[n++] = *p;
+		}
+	}
+	if (word->expand == 0)
+		plan_unescape(out);
+	word->text = out;
+}
+
+/**
+ * plan_add_word - appends a word to a command template
+ * @command: command being compiled
+ * @text: start of the word
+ * @len: length of the word
+ */
+static void plan_add_word(plan_command_t *command, const char *text, size_t len)
+{
+	plan_word_t *words;
+
+	words = realloc(command->words, (command->word_count + 1) * sizeof(*words));
+	if (words == NULL)
+	{
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+	command->words = words;
+	plan_set_word(&words[command->word_count++], text, len);
+
+	/* Prefix assignments are recognised once, at compile time */
+	if (command->assign_count == command->word_count - 1 &&
+	    plan_assignment_length(text, text + len) != 0)
+		command->assign_count++;
+}
+
+
+/**
+ * plan_add_redirect - appends a redirection to a command template
+ * @command: command being compiled
+ * @type: REDIRECT_* type
+ * @text: start of the file name
+ * @len: length of the file name, 0 if it is missing
+ */
+static void plan_add_redirect(plan_command_t *command, int type,
+			      const char *text, size_t len)
+{
+	plan_redirect_t *redirects;
+
+	redirects = realloc(command->redirects,
+			    (command->redirect_count + 1) * sizeof(*redirects));
+	if (redirects == NULL)
+	{
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+	command->redirects = redirects;
+	redirects[command->redirect_count].type = type;
+	plan_set_word(&redirects[command->redirect_count++].target, text, len);
+}
+
+/**
+ * plan_word_needs_shell - tells whether a word uses syntax left to
+ * /bin/sh
+ * @word: start of the word
+ * @end: end of the word
+ *
+ * The compiler knows quotes, backslashes, ~ and ~/, and $NAME, ${NAME},
+ * $?, $$ and $! anywhere in a word. Command substitution, other
+ * expansions, globs, subshells, ~user and an unterminated quote are
+ * left to /bin/sh.
+ * Return: 1 if the word must be run by /bin/sh, 0 otherwise
+ */
+static int plan_word_needs_shell(const char *word, const char *end)
+{
+	const char *p, *name;
+	char quote = 0;
+
+	for (p = word; p < end; p++)
+	{
+		if (*p == '\\' && quote != '\'' && p + 1 < end)
+			p++;
+		else if ((*p == '\'' || *p == '"') && (quote == 0 || quote == *p))
+			quote = quote == 0 ? *p : 0;
+		else if (*p == '`' && quote != '\'')
+			return (1);
+		else if (*p == '$' && quote != '\'' && plan_is_reference(p, end))
+		{
+			/* Skip to the last character of the reference */
+			name = p + 1 + (p[1] == '{');
+			p = plan_name_end(name, end) - (name == p + 1);
+		}
+		else if (*p == '$' && quote != '\'' && p + 1 < end &&
+			 strchr("({0123456789#@*-", p[1]) != NULL)
+			return (1);
+		else if (quote == 0 && (strchr("*?[()", *p) != NULL ||
+					plan_tilde(word, p, end) == -1))
+			return (1);
+	}
+	return (quote != 0);
+}
+
+/**
+ * plan_build - compiles a line into a new execution plan
+ * @line: line to compile, not necessarily NUL-terminated
+ * @len: length of the line
+ *
+ * The whole line is compiled even when part of it is left to /bin/sh,
+ * so plan_execute can tell what the line would have run.
+ * Return: the plan
+ */
+static plan_t *plan_build(const char *line, size_t len)
+{
+	plan_t *plan = plan_alloc(sizeof(*plan));
+	plan_command_t *command = plan_add_command(plan);
+	const char *p = line, *end = line + len, *start, *digit;
+	int op, op_len, type;
+
+	while (p < end)
+	{
+		if (*p == ' ' || *p == '\t' || *p == '\r')
+		{
+			p++;
+			continue;
+		}
+		if (*p == '#')
+			break;
+
+		op_len = plan_operator(p, end, &op);
+		if (op_len != 0)
+		{
+			command->next_op = op;
+			command = plan_add_command(plan);
+			p += op_len;
+			continue;
+		}
+
+		if (*p == '<' || *p == '>')
+		{
+			type = *p == '<' ? REDIRECT_IN : REDIRECT_OUT;
+			if (++p < end && type == REDIRECT_OUT && *p == '>')
+			{
+				type = REDIRECT_APPEND;
+				p++;
+			}
+			/* <<, <>, >& and >| */
+			if (p < end && strchr("<>&|", *p) != NULL)
+				plan->shell = 1;
+			while (p < end && (*p == ' ' || *p == '\t'))
+				p++;
+			start = p;
+			p = plan_word_end(p, end);
+			plan->shell |= plan_word_needs_shell(start, p);
+			plan_add_redirect(command, type, start, p - start);
+			continue;
+		}
+
+		start = p;
+		p = plan_word_end(p, end);
+		plan->shell |= plan_word_needs_shell(start, p);
+		/* 2>file: the digits name a descriptor */
+		digit = start;
+		while (digit < p && *digit >= '0' && *digit <= '9')
+			digit++;
+		if (digit == p && p < end && (*p == '<' || *p == '>'))
+			plan->shell = 1;
+		plan_add_word(command, start, p - start);
+	}
+
+	plan->source = plan_alloc(len + 1);
+	memcpy(plan->source, line, len);
+	plan->source_len = len;
+	return (plan);
+}
+
+/**
+ * plan_compile - returns the execution plan of a line
+ * @line: line to compile, not necessarily NUL-terminated
+ * @len: length of the line
+ *
+ * Plans are immutable and cached by their source text, so a line
+ * that runs again is not tokenized again.
+ * Return: the plan, to be handed back with plan_release
+ */
+plan_t *plan_compile(const char *line, size_t len)
+{
+	unsigned long hash = plan_hash(line, len);
+	plan_t **bucket = &plan_cache[hash % PLAN_CACHE_SIZE];
+	plan_t *plan;
+
+	for (plan = *bucket; plan != NULL; plan = plan->next)
+	{
+		if (plan->hash == hash && plan->source_len == len &&
+		    memcmp(plan->source, line, len) == 0)
+			return (plan);
+	}
+
+	plan = plan_build(line, len);
+	plan->hash = hash;
+
+	/* Scripts made of unique lines would only grow the cache */
+	if (plan_cache_count < PLAN_CACHE_LIMIT)
+	{
+		plan->cached = 1;
+		plan->next = *bucket;
+		*bucket = plan;
+		plan_cache_count++;
+	}
+	return (plan);
+}
+
+/**
+ * plan_release - frees a plan that did not make it into the cache
+ * @plan: plan returned by plan_compile
+ */
+void plan_release(plan_t *plan)
+{
+	int i, j;
+
+	if (plan->cached)
+		return;
+
+	for (i = 0; i < plan->command_count; i++)
+	{
+		for (j = 0; j < plan->commands[i].word_count; j++)
+			free(plan->commands[i].words[j].text);
+		free(plan->commands[i].words);
+		for (j = 0; j < plan->commands[i].redirect_count; j++)
+			free(plan->commands[i].redirects[j].target.text);
+		free(plan->commands[i].redirects);
+	}
+	free(plan->commands);
+	free(plan->source);
+	free(plan);
+}
+
+/**
+ * plan_number - formats a number into the arena
+ * @n: number to format
+ * Return: the number as a string
+ */
+static char *plan_number(long n)
+{
+	char *text = arena_alloc(24) + 23;
+	unsigned long value = n < 0 ? -(unsigned long)n : (unsigned long)n;
+
+	*text = '\0';
+	do {
+		*--text = '0' + value % 10;
+		value /= 10;
+	} while (value != 0);
+	if (n < 0)
+		*--text = '-';
+	return (text);
+}
+
+/**
+ * plan_variable - looks up a variable or a special parameter
+ * @name: name without its $
+ * Return: the value, NULL if it is unset
+ */
+static char *plan_variable(const char *name)
+{
+	if (strcmp(name, "?") == 0)
+		return (plan_number(last_status));
+	if (strcmp(name, "$") == 0)
+		return (plan_number(getpid()));
+	if (strcmp(name, "!") == 0)
+		return (jobs_last_pid() ? plan_number(jobs_last_pid()) : NULL);
+	return (env_get(name));
+}
+
+/**
+ * plan_expand_template - fills in the references inside a word
+ * @text: word with $NAME or ${NAME} references
+ *
+ * A backslash keeps the next character as is, as does a $ that
+ * starts no reference. The values are looked up twice, once to size
+ * the result and once to copy them.
+ * Return: the word, allocated in the arena, NULL if it is empty
+ */
+static char *plan_expand_template(const char *text)
+{
+	const char *p, *name, *name_end, *end = text + strlen(text);
+	char *result = NULL, *value;
+	size_t len = 0, pass, value_len;
+	int escaped;
+
+	for (pass = 0; pass < 2; pass++)
+	{
+		if (pass == 1)
+			result = arena_alloc(len + 1);
+		len = 0;
+		for (p = text; p < end; p = name_end)
+		{
+			escaped = *p == '\\' && p + 1 < end;
+			p += escaped;
+			name = p + 1 + (p + 1 < end && p[1] == '{');
+			name_end = *p == '$' ? plan_name_end(name, end) : p;
+			if (*p != '$' || escaped || name_end == name ||
+			    (name > p + 1 && (name_end == end || *name_end != '}')))
+			{
+				if (pass == 1)
+					result[len] = *p;
+				len++;
+				name_end = p + 1;
+				continue;
+			}
+			value = plan_variable(arena_strndup(name, name_end - name));
+			value_len = value != NULL ? strlen(value) : 0;
+			if (pass == 1)
+				memcpy(result + len, value, value_len);
+			len += value_len;
+			name_end += name > p + 1;
+		}
+	}
+	result[len] = '\0';
+	return (len > 0 ? result : NULL);
+}
+
+/**
+ * plan_expand_word - fills in one word template
+ * @word: word template
+ * Return: the value of the word, NULL for an unquoted word that
+ * expands to nothing
+ */
+static char *plan_expand_word(plan_word_t *word)
+{
+	char *value;
+
+	if (word->expand == 0)
+		return (word->text);
+	if (word->expand == 1)
+		value = plan_variable(word->text);
+	else
+		value = plan_expand_template(word->text);
+	/* "$EMPTY" is still a word, $EMPTY is none */
+	if (value == NULL || *value == '\0')
+		return (word->quoted ? "" : NULL);
+	return (value);
+}
+
+/**
+ * plan_expand - builds the argument vector of a command template
+ * @command: compiled command
+ *
+ * Expansion slots whose variable is unset produce no word at all.
+ * Return: NULL-terminated argument vector, allocated in the arena
+ */
+static char **plan_expand(plan_command_t *command)
+{
+	char **args = arena_alloc((command->word_count + 1) * sizeof(*args));
+	int i, argc = 0;
+	char *value;
+
+	for (i = 0; i < command->word_count; i++)
+	{
+		value = plan_expand_word(&command->words[i]);
+		if (value != NULL)
+			args[argc++] = value;
+	}
+	args[argc] = NULL;
+	return (args);
+}
+
+/**
+ * plan_prepare - expands a command and resolves what it runs
+ * @command: compiled command
+ * @envp: set to the environment of an external command, or to the
+ * NAME=value prefix of a builtin; NULL when there is no prefix
+ * @builtin: set to the builtin to run, NULL for an external command
+ * @status: set to the exit status when there is nothing to run
+ * Return: argument vector with the resolved command in args[0], or
+ * NULL when there is nothing to run
+ */
+static char **plan_prepare(plan_command_t *command, char ***envp,
+			   const builtin_t **builtin, int *status)
+{
+	long long start = STAT_START();
+	char **args, **assignments = NULL;
+	char *path, *search = NULL;
+	int i;
+
+	if (trace_enabled && command->word_count > 0)
+		trace_command(command->words[0].text,
+			      strlen(command->words[0].text));
+	args = plan_expand(command);
+	*envp = NULL;
+	*builtin = NULL;
+	if (command->assign_count > 0)
+	{
+		/* Assignments alone set shell variables */
+		if (args[command->assign_count] == NULL)
+		{
+			for (i = 0; i < command->assign_count; i++)
+				env_assign(args[i]);
+			*status = 0;
+			return (NULL);
+		}
+		assignments = args;
+		args += command->assign_count;
+	}
+
+	args = expand_alias(args);
+	/* Builtins are recognised before any PATH lookup */
+	if (args[0] != NULL)
+		*builtin = find_builtin(args[0]);
+	if (assignments != NULL && *builtin != NULL)
+	{
+		*envp = arena_alloc((command->assign_count + 1) * sizeof(**envp));
+		memcpy(*envp, assignments, command->assign_count * sizeof(**envp));
+		(*envp)[command->assign_count] = NULL;
+	}
+	else if (assignments != NULL)
+		*envp = env_overlay(assignments, command->assign_count);
+	STAT_RECORD(STAT_EXPAND, start);
+	if (args[0] == NULL)
+	{
+		*status = last_status;
+		return (NULL);
+	}
+	if (*builtin != NULL)
+		return (args);
+
+	/* PATH=dir cmd looks cmd up in dir, the last assignment winning */
+	for (i = 0; assignments != NULL && i < command->assign_count; i++)
+	{
+		if (strncmp(assignments[i], "PATH=", 5) == 0)
+			search = assignments[i] + 5;
+	}
+	start = STAT_START();
+	path = search != NULL ? find_command_in(args[0], search)
+		: find_command(args[0]);
+	STAT_RECORD(STAT_LOOKUP, start);
+	if (path == NULL)
+	{
+		STAT_COUNT(STAT_ENOENT);
+		write(STDERR_FILENO, "Command not found\n", 18);
+		*status = 127;
+		return (NULL);
+	}
+	args[0] = path;
+	return (args);
+}
+
+/**
+ * plan_redirect - opens the files a command is redirected to
+ * @command: compiled command
+ * @in: set to the descriptor for standard input, left alone if none
+ * @out: set to the descriptor for standard output, left alone if none
+ *
+ * The files are opened close-on-exec; the last redirection of a
+ * descriptor wins.
+ * Return: 0 on success, -1 if a file could not be opened
+ */
+static int plan_redirect(plan_command_t *command, int *in, int *out)
+{
+	plan_redirect_t *redirect;
+	int i, fd, flags, *target;
+	char *name;
+
+	for (i = 0; i < command->redirect_count; i++)
+	{
+		redirect = &command->redirects[i];
+		name = plan_expand_word(&redirect->target);
+		if (name == NULL || *name == '\0')
+		{
+			write(STDERR_FILENO, "Missing redirection target\n", 27);
+			return (-1);
+		}
+
+		flags = O_WRONLY | O_CREAT | O_TRUNC;
+		if (redirect->type == REDIRECT_IN)
+			flags = O_RDONLY;
+		else if (redirect->type == REDIRECT_APPEND)
+			flags = O_WRONLY | O_CREAT | O_APPEND;
+		fd = open(name, flags | O_CLOEXEC, 0666);
+		if (fd == -1)
+		{
+			perror(name);
+			return (-1);
+		}
+
+		target = redirect->type == REDIRECT_IN ? in : out;
+		if (*target != -1)
+			close(*target);
+		*target = fd;
+	}
+	return (0);
+}
+
+/**
+ * plan_close - closes the descriptors a command was started with
+ * @in: descriptor for standard input, -1 for none
+ * @out: descriptor for standard output, -1 for none
+ */
+static void plan_close(int in, int out)
+{
+	if (in != -1)
+		close(in);
+	if (out != -1)
+		close(out);
+}
+
+/**
+ * plan_run_builtin - runs a builtin in the shell with its own stdio
+ * @builtin: builtin to run
+ * @args: command arguments
+ * @assignments: NAME=value prefix of the builtin, NULL for none
+ * @in: descriptor for standard input, -1 for the shell's
+ * @out: descriptor for standard output, -1 for the shell's
+ *
+ * Builtins write through the shared buffer, which is pointed at @out
+ * while they run and back afterwards, so no subshell is needed. The
+ * prefix assignments hold only while the builtin runs.
+ * Return: exit status of the builtin
+ */
+static int plan_run_builtin(const builtin_t *builtin, char **args,
+			    char **assignments, int in, int out)
+{
+	builtin_io_t io = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+	env_saved_t *saved;
+	int status;
+
+	if (in != -1)
+		io.in = in;
+	if (out != -1)
+		io.out = out;
+	saved = env_push(assignments);
+	status = run_builtin(builtin, args, &io);
+	env_pop(saved);
+	return (status);
+}
+
+/**
+ * plan_wait - waits for a command and converts its wait status
+ * @pid: child to wait for
+ * @deadline: time limit of the command
+ *
+ * Under the time keyword the child's resource usage is added to the
+ * pipeline's.
+ * Return: exit status of the command, 128 + signal if it was killed,
+ * 124 if it ran out of time
+ */
+static int plan_wait(pid_t pid, deadline_t *deadline)
+{
+	long long start = STAT_START();
+	int status;
+
+	deadline_wait(deadline, pid, &status, plan_usage);
+	STAT_RECORD(STAT_WAIT, start);
+	if (deadline->expired)
+		return (124);
+	if (WIFSIGNALED(status))
+		return (128 + WTERMSIG(status));
+	return (WEXITSTATUS(status));
+}
+
+/**
+ * plan_run_command - runs one command of a plan
+ * @command: compiled command
+ *
+ * Under SHELL_TIMEOUT an external command is started in a process
+ * group of its own, so it can be signalled with its children.
+ * Return: exit status of the command
+ */
+static int plan_run_command(plan_command_t *command)
+{
+	const builtin_t *builtin;
+	char **args, **envp;
+	int status, in = -1, out = -1;
+	deadline_t deadline;
+	pid_t pid;
+
+	if (plan_redirect(command, &in, &out) == -1)
+	{
+		plan_close(in, out);
+		return (1);
+	}
+
+	args = plan_prepare(command, &envp, &builtin, &status);
+	pid = 0;
+	if (args != NULL && builtin != NULL)
+		status = plan_run_builtin(builtin, args, envp, in, out);
+	else if (args != NULL)
+	{
+		deadline_default(&deadline);
+		if (deadline.expires != 0)
+			spawn_process_group(0);
+		pid = spawn_command(args, envp, in, out);
+		spawn_process_group(-1);
+		if (deadline.expires != 0)
+			deadline.group = pid;
+	}
+	plan_close(in, out);
+	if (args == NULL || builtin != NULL)
+		return (status);
+
+	if (pid == -1)
+	{
+		perror("fork");
+		exit(EXIT_FAILURE);
+	}
+	if (pid == 0)
+		return (126);
+	deadline_terminal(deadline.group);
+	status = plan_wait(pid, &deadline);
+	deadline_terminal(0);
+	return (status);
+}
+
+/**
+ * plan_run_shell - runs a whole line through /bin/sh
+ * @plan: plan of a line that uses syntax left to /bin/sh
+ *
+ * The line behaves as it did when every script line went through
+ * system(), under the same timeout as any other command.
+ * Return: exit status of the line
+ */
+static int plan_run_shell(plan_t *plan)
+{
+	char *args[] = {"/bin/sh", "-c", NULL, NULL};
+	deadline_t deadline;
+	pid_t pid;
+	int status;
+
+	args[2] = plan->source;
+	deadline_default(&deadline);
+	if (deadline.expires != 0)
+		spawn_process_group(0);
+	pid = spawn_command(args, NULL, -1, -1);
+	spawn_process_group(-1);
+	if (deadline.expires != 0)
+		deadline.group = pid;
+	if (pid == -1)
+	{
+		perror("fork");
+		exit(EXIT_FAILURE);
+	}
+	if (pid == 0)
+		return (126);
+	deadline_terminal(deadline.group);
+	status = plan_wait(pid, &deadline);
+	deadline_terminal(0);
+	return (status);
+}
+
+/**
+ * plan_shell_refuses - tells whether a line left to /bin/sh would
+ * only change the state of the subshell
+ * @plan: plan of a line that uses syntax left to /bin/sh
+ *
+ * A command made of assignments, or one that starts with a builtin or
+ * an alias, past any reserved word, would silently do nothing in
+ * /bin/sh; it is reported on standard error instead.
+ * Return: 1 if the line must not be run, 0 otherwise
+ */
+static int plan_shell_refuses(plan_t *plan)
+{
+	static const char * const reserved[] = {"!", "{", "if", "then", "else",
+		"elif", "while", "until", "do", NULL};
+	plan_word_t *words;
+	int i, j, k, first, count;
+	size_t len;
+
+	for (i = 0; i < plan->command_count; i++)
+	{
+		words = plan->commands[i].words;
+		count = plan->commands[i].word_count;
+		for (j = 0, k = 0; j < count && reserved[k] != NULL; k++)
+		{
+			if (words[j].expand == 0 && !words[j].quoted &&
+			    strcmp(words[j].text, reserved[k]) == 0)
+			{
+				j++;
+				k = -1;
+			}
+		}
+		first = j;
+		while (j < count && (j < plan->commands[i].assign_count ||
+		       (words[j].expand != 1 && assignment_name_length(words[j].text))))
+			j++;
+
+		len = 0;
+		if (j == count && j > first)
+			len = assignment_name_length(words[first].text);
+		else if (j < count && words[j].expand == 0 &&
+			 (find_builtin(words[j].text) || find_alias(words[j].text)))
+			len = strlen(words[first = j].text);
+		if (len != 0)
+		{
+			write(STDERR_FILENO, words[first].text, len);
+			write(STDERR_FILENO, ": unsupported syntax\n", 21);
+			return (1);
+		}
+	}
+	return (0);
+}
+
+/**
+ * plan_start_builtin - runs a builtin as a stage of a pipeline
+ * @builtin: builtin to run
+ * @args: command arguments
+ * @assignments: NAME=value prefix of the builtin, NULL for none
+ * @in: read end of the previous pipe, -1 for none
+ * @out: write end of the next pipe, -1 for none
+ * @group: process group to join, 0 for a new one, -1 for the shell's
+ *
+ * The stage runs in a child like any other, so it cannot block the
+ * shell; its output reaches the pipe through vmsplice.
+ * Return: pid of the child, -1 on failure
+ */
+static pid_t plan_start_builtin(const builtin_t *builtin, char **args,
+				char **assignments, int in, int out, pid_t group)
+{
+	builtin_io_t io = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+	pid_t pid;
+
+	buffer_flush();
+	pid = fork();
+	if (pid != -1)
+		STAT_COUNT(STAT_FORKS);
+	if (pid > 0)
+		trace_child(pid, 1);
+	if (pid > 0 && group != -1)
+		setpgid(pid, group != 0 ? group : pid);
+	if (pid != 0)
+		return (pid);
+
+	/* The shell traces the stage from outside, as any other child */
+	trace_enabled = 0;
+	if (group != -1)
+		setpgid(0, group);
+
+	if (in != -1)
+		dup2(in, STDIN_FILENO);
+	if (out != -1)
+	{
+		dup2(out, STDOUT_FILENO);
+		buffer_use_vmsplice();
+	}
+	env_push(assignments);
+	_exit(run_builtin(builtin, args, &io));
+}
+
+/**
+ * plan_pipe - creates the pipe between two stages of a pipeline
+ * @fds: set to the read and write ends
+ *
+ * Both ends are close-on-exec: a stage only keeps the ends it had
+ * duplicated onto its standard input and output. SHELL_PIPE_SIZE
+ * asks for a larger pipe buffer, in bytes.
+ * Return: 0 on success, -1 on error
+ */
+static int plan_pipe(int fds[2])
+{
+	char *size = env_get("SHELL_PIPE_SIZE");
+
+	if (pipe2(fds, O_CLOEXEC) == -1)
+	{
+		perror("pipe");
+		return (-1);
+	}
+	if (size != NULL && atoi(size) > 0)
+		fcntl(fds[1], F_SETPIPE_SZ, atoi(size));
+	return (0);
+}
+
+/**
+ * plan_describe - rebuilds the text of a pipeline for the job table
+ * @commands: first command of the pipeline
+ * @count: number of commands
+ * Return: the text, allocated in the arena
+ */
+static char *plan_describe(plan_command_t *commands, int count)
+{
+	size_t len = 1, pos = 0, word_len;
+	char *text;
+	int i, j;
+
+	for (i = 0; i < count; i++)
+	{
+		for (j = 0; j < commands[i].word_count; j++)
+			len += strlen(commands[i].words[j].text) + 2;
+		len += 3;
+	}
+	text = arena_alloc(len);
+
+	for (i = 0; i < count; i++)
+	{
+		if (i > 0)
+		{
+			memcpy(text + pos, " | ", 3);
+			pos += 3;
+		}
+		for (j = 0; j < commands[i].word_count; j++)
+		{
+			if (j > 0)
+				text[pos++] = ' ';
+			if (commands[i].words[j].expand == 1)
+				text[pos++] = '$';
+			word_len = strlen(commands[i].words[j].text);
+			memcpy(text + pos, commands[i].words[j].text, word_len);
+			pos += word_len;
+		}
+	}
+	text[pos] = '\0';
+	return (text);
+}
+
+/**
+ * plan_run_pipeline - runs commands joined by pipes
+ * @commands: first command of the pipeline
+ * @count: number of commands
+ * @background: 1 to add the pipeline to the job table instead of
+ * waiting for it
+ *
+ * Every stage is started before any of them is waited for. A builtin
+ * in the last stage of a foreground pipeline runs in the shell
+ * itself, once the others have been started. Under SHELL_TIMEOUT the
+ * stages share one process group and one deadline. The first stage of
+ * a background pipeline reads /dev/null unless it is redirected.
+ * Return: exit status of the last command, 0 in the background
+ */
+static int plan_run_pipeline(plan_command_t *commands, int count,
+			     int background)
+{
+	pid_t *pids = arena_alloc(count * sizeof(*pids)), group = -1;
+	const builtin_t *builtin;
+	char **args, **envp;
+	int i, pipe_in = -1, fds[2], in, out, status = 0, stage_status;
+	int stage_in, stage_out, started = 0;
+	deadline_t deadline;
+
+	deadline_default(&deadline);
+	if (deadline.expires != 0 && !background)
+		group = 0;
+
+	for (i = 0; i < count; i++)
+	{
+		fds[0] = fds[1] = -1;
+		status = 0;
+		if (i < count - 1 && plan_pipe(fds) == -1)
+		{
+			count = i;
+			break;
+		}
+
+		pids[i] = 0;
+		in = out = -1;
+		args = NULL;
+		if (plan_redirect(&commands[i], &in, &out) == -1)
+			status = 1;
+		else
+			args = plan_prepare(&commands[i], &envp, &builtin, &status);
+		/* A background job must not read the shell's input */
+		if (i == 0 && background && in == -1)
+			in = open("/dev/null", O_RDONLY | O_CLOEXEC);
+		/* A redirection takes the place of the pipe */
+		stage_in = in != -1 ? in : pipe_in;
+		stage_out = out != -1 ? out : fds[1];
+
+		if (args != NULL && builtin != NULL && i == count - 1 && !background)
+			status = plan_run_builtin(builtin, args, envp, stage_in,
+						  stage_out);
+		else if (args != NULL && builtin != NULL)
+			pids[i] = plan_start_builtin(builtin, args, envp, stage_in,
+						     stage_out, group);
+		else if (args != NULL)
+		{
+			spawn_process_group(group);
+			pids[i] = spawn_command(args, envp, stage_in, stage_out);
+			spawn_process_group(-1);
+		}
+		/* The first stage started leads the group */
+		if (pids[i] > 0 && group == 0)
+			group = pids[i];
+		if (pids[i] == -1)
+			perror("fork");
+		else if (pids[i] == 0 && args != NULL && builtin == NULL)
+			status = 126;
+
+		plan_close(in, out);
+		plan_close(pipe_in, fds[1]);
+		pipe_in = fds[0];
+	}
+	plan_close(pipe_in, -1);
+
+	if (background)
+	{
+		for (i = 0; i < count; i++)
+		{
+			if (pids[i] > 0)
+				pids[started++] = pids[i];
+		}
+		if (started > 0)
+			job_add(pids, started, plan_describe(commands, count));
+		return (0);
+	}
+
+	deadline.group = group;
+	deadline_terminal(group);
+	for (i = 0; i < count; i++)
+	{
+		if (pids[i] <= 0)
+			continue;
+		stage_status = plan_wait(pids[i], &deadline);
+		if (i == count - 1)
+			status = stage_status;
+	}
+	deadline_terminal(0);
+	return (status);
+}
+
+/**
+ * plan_is_time - tells whether a pipeline starts with the time keyword
+ * @command: first command of the pipeline
+ * Return: 1 if it does, 0 otherwise
+ */
+static int plan_is_time(plan_command_t *command)
+{
+	return (command->word_count > 0 && command->assign_count == 0 &&
+		!command->words[0].expand &&
+		strcmp(command->words[0].text, "time") == 0);
+}
+
+/**
+ * plan_time - runs a pipeline prefixed with the time keyword
+ * @commands: first command of the pipeline, starting with time
+ * @count: number of commands
+ * @background: 1 if the pipeline runs in the background
+ *
+ * time [-j] PIPELINE prints the elapsed time and what every process of
+ * the pipeline used on standard error, or a single JSON object with
+ * -j. The children are reaped with wait4, so the numbers come with
+ * the exit status. A background pipeline is started untimed.
+ * Return: exit status of the pipeline
+ */
+static int plan_time(plan_command_t *commands, int count, int background)
+{
+	plan_command_t *timed = arena_alloc(count * sizeof(*timed));
+	struct rusage usage, before;
+	int skip = 1, json = 0, status;
+	long long start;
+
+	/* The plan is shared with the cache: time is skipped in a copy */
+	memcpy(timed, commands, count * sizeof(*timed));
+	if (timed->word_count > 1 && !timed->words[1].expand &&
+	    strcmp(timed->words[1].text, "-j") == 0)
+	{
+		json = 1;
+		skip++;
+	}
+	timed->words += skip;
+	timed->word_count -= skip;
+	while (timed->assign_count < timed->word_count &&
+	       timed->words[timed->assign_count].expand != 1 &&
+	       assignment_name_length(timed->words[timed->assign_count].text))
+		timed->assign_count++;
+
+	if (background)
+		return (plan_run_pipeline(timed, count, 1));
+
+	memset(&usage, 0, sizeof(usage));
+	getrusage(RUSAGE_SELF, &before);
+	start = monotonic_ns();
+	plan_usage = &usage;
+	if (count > 1)
+		status = plan_run_pipeline(timed, count, 0);
+	else
+		status = plan_run_command(timed);
+	plan_usage = NULL;
+	start = monotonic_ns() - start;
+	usage_since(&usage, &before);
+
+	buffer_flush();
+	usage_report(STDERR_FILENO, start, &usage, status, json);
+	return (status);
+}
+
+/**
+ * plan_execute - runs an execution plan
+ * @plan: plan returned by plan_compile
+ *
+ * Commands are joined by their operator edges: | feeds a command into
+ * the next one, ; and & always run the next command, && only after a
+ * success and || only after a failure. A pipeline followed by & is
+ * not waited for.
+ * Return: exit status of the last command that ran
+ */
+int plan_execute(plan_t *plan)
+{
+	int i, count, background, run = 1;
+	plan_command_t *command;
+
+	if (plan->shell)
+	{
+		jobs_reap();
+		last_status = plan_shell_refuses(plan) ? 2 : plan_run_shell(plan);
+		return (last_status);
+	}
+
+	for (i = 0; i < plan->command_count; i++)
+	{
+		jobs_reap();
+		command = &plan->commands[i];
+		for (count = 1; command[count - 1].next_op == PLAN_PIPE &&
+		     i + count < plan->command_count; count++)
+			;
+		background = command[count - 1].next_op == PLAN_BACKGROUND;
+		if (run && plan_is_time(command))
+			last_status = plan_time(command, count, background);
+		else if (run && (count > 1 || background))
+			last_status = plan_run_pipeline(command, count, background);
+		else if (run && (command->word_count > 0 ||
+				 command->redirect_count > 0))
+			last_status = plan_run_command(command);
+
+		i += count - 1;
+		command = &plan->commands[i];
+
+		if (command->next_op == PLAN_AND)
+			run = last_status == 0;
+		else if (command->next_op == PLAN_OR)
+			run = last_status != 0;
+		else
+			run = 1;
+	}
+	return (last_status);
+}
@@ -0,0 +1,138 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "main.h"
+
+#define READER_CHUNK_SIZE (64 * 1024)
+
+/**
+ * reader_open - opens a script for line-by-line reading
+ * @reader: reader to initialise
+ * @filename: script to read
+ *
+ * Regular files are mapped read-only; pipes, FIFOs and anything that
+ * cannot be mapped are read through a growing buffer instead.
+ * Return: 0 on success, -1 on error
+ */
+int reader_open(line_reader_t *reader, const char *filename)
+{
+	struct stat st;
+	void *map;
+
+	memset(reader, 0, sizeof(*reader));
+	reader->fd = open(filename, O_RDONLY | O_CLOEXEC);
+	if (reader->fd == -1)
+		return (-1);
+
+	if (fstat(reader->fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+	{
+		map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, reader->fd, 0);
+		if (map != MAP_FAILED)
+		{
+			madvise(map, st.st_size, MADV_SEQUENTIAL);
+			reader->data = map;
+			reader->size = st.st_size;
+			reader->mapped = 1;
+			reader->eof = 1;
+		}
+	}
+	return (0);
+}
+
+/**
+ * reader_fill - reads more of a streamed script into the buffer
+ * @reader: reader to fill
+ *
+ * Unread bytes are moved to the front first; the buffer only grows
+ * when a single line does not fit in it.
+ * Return: 0 on success, -1 on error
+ */
+static int reader_fill(line_reader_t *reader)
+{
+	ssize_t read_size;
+	char *grown;
+
+	if (reader->pos > 0)
+	{
+		memmove(reader->data, reader->data + reader->pos,
+			reader->size - reader->pos);
+		reader->size -= reader->pos;
+		reader->pos = 0;
+	}
+
+	if (reader->size == reader->capacity)
+	{
+		grown = realloc(reader->data, reader->capacity + READER_CHUNK_SIZE);
+		if (grown == NULL)
+			return (-1);
+		reader->data = grown;
+		reader->capacity += READER_CHUNK_SIZE;
+	}
+
+	read_size = read(reader->fd, reader->data + reader->size,
+			 reader->capacity - reader->size);
+	if (read_size == -1)
+		return (-1);
+	if (read_size == 0)
+		reader->eof = 1;
+	reader->size += read_size;
+	return (0);
+}
+
+/**
+ * reader_next - yields the next line of a script without copying it
+ * @reader: reader to read from
+ * @line: set to the start of the line, which is not NUL-terminated
+ * @len: set to the length of the line, without the newline
+ *
+ * The line stays valid until the next call on the same reader.
+ * Return: 1 if a line was read, 0 at end of file, -1 on error
+ */
+int reader_next(line_reader_t *reader, const char **line, size_t *len)
+{
+	char *start, *newline = NULL;
+	size_t scanned = 0;
+
+	while (1)
+	{
+		start = reader->data + reader->pos;
+		if (reader->size > reader->pos + scanned)
+			newline = memchr(start + scanned, '\n',
+					 reader->size - reader->pos - scanned);
+		if (newline != NULL)
+		{
+			*line = start;
+			*len = newline - start;
+			reader->pos += *len + 1;
+			return (1);
+		}
+
+		if (reader->eof)
+		{
+			if (reader->pos == reader->size)
+				return (0);
+			/* Last line without a trailing newline */
+			*line = start;
+			*len = reader->size - reader->pos;
+			reader->pos = reader->size;
+			return (1);
+		}
+
+		scanned = reader->size - reader->pos;
+		if (reader_fill(reader) == -1)
+			return (-1);
+	}
+}
+
+/**
+ * reader_close - releases a script reader
+ * @reader: reader to close
+ */
+void reader_close(line_reader_t *reader)
+{
+	if (reader->mapped)
+		munmap(reader->data, reader->size);
+	else
+		free(reader->data);
+	close(reader->fd);
+}
@@ -13,7 +13,8 @@
  */
 void print_prompt(void)
 {
-	write(STDOUT_FILENO, "$ ", 2);
+	if (is_interactive())
+		write(STDOUT_FILENO, "$ ", 2);
 }
 
 /**
@@ -23,129 +24,67 @@ void print_prompt(void)
  */
 ssize_t read_input(char *input)
 {
-	ssize_t read_size = read(STDIN_FILENO, input, MAX_INPUT_LENGTH);
-
-	if (read_size == -1)
-	{
-		perror("read");
-		exit(EXIT_FAILURE);
-	}
-	else if (read_size == 0)
-	{
-		write(STDOUT_FILENO, "\n", 1);
-		exit(EXIT_SUCCESS);
-	}
-	/* Remove newline character from end of command */
-	input[read_size - 1] = '\0';
+	ssize_t read_size = read_line(input, MAX_INPUT_LENGTH);
 	return (read_size);
 }
 
 /**
- * execute_command - executes command
+ * run_command - executes a one-word command
  * @command: command to execute
  */
-void execute_command(char *command)
+void run_command(char *command)
 {
-	pid_t pid = fork();
+	char *args[] = {command, NULL};
+	pid_t pid;
 	int status;
 
+	if (access(command, F_OK) == -1)
+	{
+		write(STDERR_FILENO, "Command not found\n", 18);
+		return;
+	}
+
+	pid = spawn_command(args, NULL, -1, -1);
 	if (pid == -1)
 	{
 		perror("fork");
 		exit(EXIT_FAILURE);
 	}
-	else if (pid == 0)
+	else if (pid > 0)
 	{
-		/* Child process */
-		/* Execute command */
-		if (access(command, F_OK) != -1)
-		{
-			execve(command, NULL, environ);
-			perror("execve");
-			_exit(EXIT_FAILURE);
-		}
-		else
-		{
-			write(STDERR_FILENO, "Command not found\n", 18);
-			_exit(EXIT_FAILURE);
-		}
-	}
-	else
-	{
-		/* Parent process */
 		/* Wait for child process to complete */
-		do {
-			waitpid(pid, &status, WUNTRACED);
-		} while (!WIFEXITED(status) && !WIFSIGNALED(status));
-	}
-}
-
-/**
- * set_env_variable - set or modify an environment variable
- * @variable: name of the variable
- * @value: value to set for the variable
- * Return: 0 on success, -1 on failure
- */
-int set_env_variable(const char *variable, const char *value)
-{
-	if (setenv(variable, value, 1) != 0)
-	{
-		perror("setenv");
-		return -1;
+		wait_for_child(pid, &status);
 	}
-	return 0;
 }
 
 /**
- * unset_env_variable - unset an environment variable
- * @variable: name of the variable to unset
- * Return: 0 on success, -1 on failure
+ * parse_command - splits a command line into words
+ * @input: command line, split in place
+ * Return: NULL-terminated argument vector, allocated in the arena
  */
-int unset_env_variable(const char *variable)
+char **parse_command(char *input)
 {
-	if (unsetenv(variable) != 0)
-	{
-		perror("unsetenv");
-		return -1;
-	}
-	return 0;
-}
+	size_t size = MAX_NUM_ARGS, i = 0;
+	char **args = arena_alloc(size * sizeof(*args));
+	char **grown;
+	char *arg = strtok(input, " ");
 
-/**
- * handle_builtin_commands - handle builtin commands
- * @args: command arguments
- * Return: 1 if command is builtin, 0 otherwise
- */
-int handle_builtin_commands(char **args)
-{
-	if (strcmp(args[0], "setenv") == 0)
+	while (arg != NULL)
 	{
-		if (args[1] != NULL && args[2] != NULL)
-		{
-			if (set_env_variable(args[1], args[2]) != 0)
-				return 0;
-		}
-		else
+		/* Grow the argument vector instead of truncating the command */
+		if (i == size - 1)
 		{
-			write(STDERR_FILENO, "Usage: setenv VARIABLE VALUE\n", 29);
+			grown = arena_alloc(2 * size * sizeof(*args));
+			memcpy(grown, args, i * sizeof(*args));
+			args = grown;
+			size *= 2;
 		}
-		return 1;
-	}
-	else if (strcmp(args[0], "unsetenv") == 0)
-	{
-		if (args[1] != NULL)
-		{
-			if (unset_env_variable(args[1]) != 0)
-				return 0;
-		}
-		else
-		{
-			write(STDERR_FILENO, "Usage: unsetenv VARIABLE\n", 25);
-		}
-		return 1;
+		args[i++] = arg;
+		arg = strtok(NULL, " ");
 	}
+	args[i] = NULL;
 
-	return 0;
+	return (args);
 }
 
 /**
@@ -158,9 +97,8 @@ int handle_builtin_commands(char **args)
 int main(int argc, char **argv)
 {
 	char input[MAX_INPUT_LENGTH];
-	char *args[MAX_INPUT_LENGTH];
-	char **environ;
-	int is_builtin_command;
+	char **args;
+	const builtin_t *builtin;
 
 	while (1)
 	{
@@ -170,13 +108,16 @@ int main(int argc, char **argv)
 		if (read_size == 0)
 			continue;
 
-		is_builtin_command = 0;
-		parse_command(input, args);
-
-		is_builtin_command = handle_builtin_commands(args);
+		arena_reset();
+		args = parse_command(input);
+		if (args[0] == NULL)
+			continue;
 
-		if (!is_builtin_command)
-			execute_command(args[0]);
+		builtin = find_builtin(args[0]);
+		if (builtin != NULL)
+			run_builtin(builtin, args, NULL);
+		else
+			run_command(args[0]);
 	}
 
 	return (0);
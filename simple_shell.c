@@ -6,37 +6,36 @@
 #include <sys/types.h>
 #include "main.h"
 
-#define MAX_INPUT_LENGTH 1024
+/**
+ * print_prompt - prints shell prompt
+ */
+void print_prompt(void)
+{
+	if (is_interactive())
+		write(STDOUT_FILENO, "$ ", 2);
+}
 
 /**
- * execute_command - executes command
- * @command: command to execute
+ * execute_line - executes a command line
+ * @command: command line to execute
+ * @len: length of the command line
+ *
+ * The line is compiled once into an execution plan; a line seen
+ * before reuses its cached plan.
  */
-void execute_command(char *command)
+void execute_line(const char *command, size_t len)
 {
-	pid_t pid = fork();
-	int status;
+	long long start = STAT_START();
+	plan_t *plan;
 
-	if (pid == -1)
-	{
-		perror("fork");
-		exit(EXIT_FAILURE);
-	}
-	else if (pid == 0)
-	{
-		/* Child process */
-		/* Execute command */
-		system(command);
-		_exit(EXIT_SUCCESS);
-	}
-	else
-	{
-		/* Parent process */
-		/* Wait for child process to complete */
-		do {
-			waitpid(pid, &status, WUNTRACED);
-		} while (!WIFEXITED(status) && !WIFSIGNALED(status));
-	}
+	if (trace_enabled)
+		trace_command(command, len);
+	plan = plan_compile(command, len);
+
+	STAT_RECORD(STAT_PARSE, start);
+	plan_execute(plan);
+	plan_release(plan);
+	arena_reset();
 }
 
 /**
@@ -45,22 +44,24 @@ void execute_command(char *command)
  */
 void read_commands_from_file(const char *filename)
 {
-	FILE *file = fopen(filename, "r");
-	char line[MAX_INPUT_LENGTH];
+	line_reader_t reader;
+	const char *line;
+	size_t len;
+	int result;
 
-	if (file == NULL)
+	if (reader_open(&reader, filename) == -1)
 	{
-		perror("fopen");
+		perror("open");
 		exit(EXIT_FAILURE);
 	}
 
-	while (fgets(line, sizeof(line), file) != NULL)
-	{
-		line[strcspn(line, "\n")] = '\0'; // Remove newline character
-		execute_command(line);
-	}
+	while ((result = reader_next(&reader, &line, &len)) == 1)
+		execute_line(line, len);
 
-	fclose(file);
+	if (result == -1)
+		perror("read");
+
+	reader_close(&reader);
 }
 
 /**
@@ -72,6 +73,8 @@ void read_commands_from_file(const char *filename)
  */
 int main(int argc, char **argv)
 {
+	stats_init();
+	trace_init();
 	if (argc > 1)
 	{
 		/* Run commands from file */
@@ -79,20 +82,16 @@ int main(int argc, char **argv)
 	}
 	else
 	{
-		/* Interactive mode */
-		char input[MAX_INPUT_LENGTH];
+		/* Commands from stdin, a terminal or a pipe */
+		char *input = NULL;
+		size_t size = 0;
+		ssize_t len;
 
 		while (1)
 		{
-			printf("$ ");
-			fflush(stdout);
-
-			if (fgets(input, sizeof(input), stdin) == NULL)
-				break;
-
-			input[strcspn(input, "\n")] = '\0'; // Remove newline character
-
-			execute_command(input);
+			print_prompt();
+			len = read_long_line(&input, &size);
+			execute_line(input, len);
 		}
 	}
 
@@ -0,0 +1,306 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <spawn.h>
+#include "main.h"
+
+#ifndef SPAWN_BACKEND
+#define SPAWN_BACKEND SPAWN_POSIX
+#endif
+
+#define CLONE_STACK_SIZE (64 * 1024)
+
+static int spawn_backend = -1;
+static char **spawn_envp;
+static int spawn_in = -1;
+static int spawn_out = -1;
+static pid_t spawn_group = -1;
+
+/**
+ * get_spawn_backend - picks the backend used to launch commands
+ *
+ * The default is chosen at build time with -DSPAWN_BACKEND=...
+ * and can be overridden at run time through SHELL_SPAWN
+ * (fork, vfork, clone or posix_spawn).
+ * Return: one of the SPAWN_* backends
+ */
+int get_spawn_backend(void)
+{
+	char *name;
+
+	if (spawn_backend != -1)
+		return (spawn_backend);
+
+	spawn_backend = SPAWN_BACKEND;
+	name = env_get("SHELL_SPAWN");
+	if (name == NULL)
+		return (spawn_backend);
+
+	if (strcmp(name, "fork") == 0)
+		spawn_backend = SPAWN_FORK;
+	else if (strcmp(name, "vfork") == 0)
+		spawn_backend = SPAWN_VFORK;
+	else if (strcmp(name, "clone") == 0)
+		spawn_backend = SPAWN_CLONE;
+	else if (strcmp(name, "posix_spawn") == 0)
+		spawn_backend = SPAWN_POSIX;
+
+	return (spawn_backend);
+}
+
+/**
+ * print_exec_error - reports a failed execve without touching stdio
+ * @error: errno value of the failure
+ */
+static void print_exec_error(int error)
+{
+	char *message = strerror(error);
+
+	write(STDERR_FILENO, "execve: ", 8);
+	write(STDERR_FILENO, message, strlen(message));
+	write(STDERR_FILENO, "\n", 1);
+}
+
+/**
+ * execute_command - replaces the child process with the command
+ * @args: command arguments
+ *
+ * Only async-signal-safe calls are made here, since the child may
+ * share the parent's memory when started with vfork or clone.
+ */
+void execute_command(char **args)
+{
+	sigset_t empty;
+
+	/* SIGCHLD may be blocked for the shell's signalfd */
+	sigemptyset(&empty);
+	sigprocmask(SIG_SETMASK, &empty, NULL);
+	if (spawn_group != -1)
+		setpgid(0, spawn_group);
+	if (spawn_in != -1)
+		dup2(spawn_in, STDIN_FILENO);
+	if (spawn_out != -1)
+		dup2(spawn_out, STDOUT_FILENO);
+	execve(args[0], args, spawn_envp);
+	print_exec_error(errno);
+	_exit(EXIT_FAILURE);
+}
+
+/**
+ * wait_for_child - waits until a child process exits or is killed
+ * @pid: child to wait for
+ * @status: set to the wait status of the child
+ */
+void wait_for_child(pid_t pid, int *status)
+{
+	long long start = STAT_START();
+
+	wait_for_child_usage(pid, status, NULL);
+	STAT_RECORD(STAT_WAIT, start);
+}
+
+/**
+ * wait_for_child_usage - waits for a child and collects its usage
+ * @pid: child to wait for
+ * @status: set to the wait status of the child
+ * @usage: resource usage of the child is added here, NULL to drop it
+ *
+ * The child is reaped with wait4, which returns its rusage along with
+ * the status at no extra cost.
+ */
+void wait_for_child_usage(pid_t pid, int *status, struct rusage *usage)
+{
+	struct rusage child;
+
+	for (;;)
+	{
+		if (wait4(pid, status, WUNTRACED, &child) == -1)
+		{
+			if (errno == EINTR)
+				continue;
+			return;
+		}
+		if (WIFEXITED(*status) || WIFSIGNALED(*status))
+			break;
+	}
+
+	trace_child(pid, 0);
+	if (usage != NULL)
+		usage_add(usage, &child);
+}
+
+/**
+ * clone_child - entry point of a child started with clone
+ * @arg: command arguments
+ * Return: never returns
+ */
+static int clone_child(void *arg)
+{
+	execute_command(arg);
+	return (EXIT_FAILURE);
+}
+
+/**
+ * spawn_fork - launches a command with a plain fork
+ * @args: command arguments
+ * Return: pid of the child, -1 on failure
+ */
+static pid_t spawn_fork(char **args)
+{
+	pid_t pid = fork();
+
+	if (pid == 0)
+		execute_command(args);
+	return (pid);
+}
+
+/**
+ * spawn_vfork - launches a command with vfork
+ * @args: command arguments
+ * Return: pid of the child, -1 on failure
+ */
+static pid_t spawn_vfork(char **args)
+{
+	pid_t pid = vfork();
+
+	if (pid == 0)
+		execute_command(args);
+	return (pid);
+}
+
+/**
+ * spawn_clone - launches a command with clone(CLONE_VM | CLONE_VFORK)
+ * @args: command arguments
+ * Return: pid of the child, -1 on failure
+ */
+static pid_t spawn_clone(char **args)
+{
+	char *stack = malloc(CLONE_STACK_SIZE);
+	pid_t pid;
+
+	if (stack == NULL)
+		return (-1);
+
+	/* The parent is suspended until the child has exec'd */
+	pid = clone(clone_child, stack + CLONE_STACK_SIZE,
+		    CLONE_VM | CLONE_VFORK | SIGCHLD, args);
+	free(stack);
+
+	if (pid == -1 && (errno == ENOSYS || errno == EINVAL))
+		return (spawn_fork(args));
+	return (pid);
+}
+
+/**
+ * spawn_posix - launches a command with posix_spawn
+ * @args: command arguments
+ * Return: pid of the child, 0 if the command could not be executed,
+ * -1 on failure
+ */
+static pid_t spawn_posix(char **args)
+{
+	posix_spawn_file_actions_t actions;
+	posix_spawnattr_t attr;
+	sigset_t empty;
+	pid_t pid;
+	int error;
+
+	sigemptyset(&empty);
+	posix_spawnattr_init(&attr);
+	posix_spawnattr_setsigmask(&attr, &empty);
+	if (spawn_group != -1)
+		posix_spawnattr_setpgroup(&attr, spawn_group);
+	posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK
+				 | (spawn_group != -1 ? POSIX_SPAWN_SETPGROUP : 0));
+	posix_spawn_file_actions_init(&actions);
+	if (spawn_in != -1)
+		posix_spawn_file_actions_adddup2(&actions, spawn_in, STDIN_FILENO);
+	if (spawn_out != -1)
+		posix_spawn_file_actions_adddup2(&actions, spawn_out, STDOUT_FILENO);
+	error = posix_spawn(&pid, args[0], &actions, &attr, args, spawn_envp);
+	posix_spawn_file_actions_destroy(&actions);
+	posix_spawnattr_destroy(&attr);
+	if (error == 0)
+		return (pid);
+
+	if (error == ENOSYS)
+		return (spawn_fork(args));
+	if (error == EAGAIN || error == ENOMEM)
+	{
+		errno = error;
+		return (-1);
+	}
+
+	/* The child was created but execve failed */
+	print_exec_error(error);
+	return (0);
+}
+
+/**
+ * spawn_process_group - picks the process group of the next commands
+ * @group: process group to join, 0 for a new one led by the command,
+ * -1 to stay in the shell's
+ *
+ * A command in a group of its own can be signalled along with its
+ * children, which is what the timeouts rely on.
+ */
+void spawn_process_group(pid_t group)
+{
+	spawn_group = group;
+}
+
+/**
+ * spawn_command - launches a command in a child process
+ * @args: command arguments
+ * @envp: environment of the child, NULL for the exported variables
+ * @in: descriptor to use as standard input, -1 to inherit it
+ * @out: descriptor to use as standard output, -1 to inherit it
+ *
+ * Other descriptors the shell opens are close-on-exec, so only the
+ * three standard ones reach the command. fork is kept as the fallback
+ * when the selected backend is not available on this system.
+ * Return: pid of the child, 0 if the command could not be executed,
+ * -1 if no child could be created
+ */
+pid_t spawn_command(char **args, char **envp, int in, int out)
+{
+	long long start = STAT_START();
+	pid_t pid;
+
+	/* Keep builtin output ahead of anything the child writes */
+	buffer_flush();
+	/* Built here: the child may not allocate after vfork */
+	spawn_envp = envp != NULL ? envp : env_environ();
+	spawn_in = in;
+	spawn_out = out;
+
+	switch (get_spawn_backend())
+	{
+	case SPAWN_POSIX:
+		pid = spawn_posix(args);
+		break;
+	case SPAWN_CLONE:
+		pid = spawn_clone(args);
+		break;
+	case SPAWN_VFORK:
+		pid = spawn_vfork(args);
+		break;
+	default:
+		pid = spawn_fork(args);
+	}
+
+	/* Also set here, the child may not have run yet after fork */
+	if (pid > 0 && spawn_group != -1)
+		setpgid(pid, spawn_group != 0 ? spawn_group : pid);
+
+	STAT_RECORD(STAT_SPAWN, start);
+	if (pid != -1)
+		STAT_COUNT(STAT_FORKS);
+	if (pid > 0)
+	{
+		STAT_COUNT(STAT_EXECS);
+		trace_child(pid, 1);
+	}
+	return (pid);
+}
@@ -0,0 +1,224 @@
+#include "main.h"
+
+#define STAT_SUB_BITS 4
+#define STAT_SUB_BUCKETS (1 << STAT_SUB_BITS)
+#define STAT_MAX_BITS 48
+#define STAT_BUCKETS ((STAT_MAX_BITS - STAT_SUB_BITS + 1) * STAT_SUB_BUCKETS)
+
+/**
+ * struct histogram - log-bucketed latency histogram
+ * @count: number of samples
+ * @total: sum of the samples, in nanoseconds
+ * @max: largest sample, in nanoseconds
+ * @buckets: sample counts; each power of two is split into
+ * STAT_SUB_BUCKETS linear buckets, so any value is known to within
+ * 1/STAT_SUB_BUCKETS of itself
+ */
+typedef struct histogram
+{
+	unsigned long count;
+	unsigned long long total;
+	unsigned long long max;
+	unsigned long buckets[STAT_BUCKETS];
+} histogram_t;
+
+int stats_enabled;
+static histogram_t histograms[STAT_PHASES];
+unsigned long stat_counters[STAT_COUNTERS];
+
+static const char *const phase_names[STAT_PHASES] = {
+	"parse", "lookup", "spawn", "wait", "builtin", "expand"
+};
+
+static const char *const counter_names[STAT_COUNTERS] = {
+	"forks", "execs", "enoent", "builtins"
+};
+
+/**
+ * stats_init - turns the histograms on when SHELL_STATS is set
+ */
+void stats_init(void)
+{
+	char *value = env_get("SHELL_STATS");
+
+	stats_enabled = value != NULL && *value != '\0' && strcmp(value, "0") != 0;
+}
+
+/**
+ * stat_bucket - finds the bucket of a value
+ * @value: sample, in nanoseconds
+ * Return: index of the bucket
+ */
+static int stat_bucket(unsigned long long value)
+{
+	int bits;
+
+	if (value < STAT_SUB_BUCKETS)
+		return (value);
+	bits = 63 - __builtin_clzll(value);
+	if (bits >= STAT_MAX_BITS)
+		return (STAT_BUCKETS - 1);
+	/* The top STAT_SUB_BITS bits below the leading one pick the bucket */
+	return ((bits - STAT_SUB_BITS + 1) * STAT_SUB_BUCKETS +
+		((value >> (bits - STAT_SUB_BITS)) & (STAT_SUB_BUCKETS - 1)));
+}
+
+/**
+ * stat_bucket_value - largest value that falls into a bucket
+ * @bucket: index of the bucket
+ * Return: the value, in nanoseconds
+ */
+static unsigned long long stat_bucket_value(int bucket)
+{
+	int shift;
+
+	if (bucket < STAT_SUB_BUCKETS)
+		return (bucket);
+	shift = bucket / STAT_SUB_BUCKETS - 1;
+	return ((((unsigned long long)STAT_SUB_BUCKETS + bucket % STAT_SUB_BUCKETS)
+		 << shift) + (1ULL << shift) - 1);
+}
+
+/**
+ * stat_record - adds one sample to the histogram of a phase
+ * @phase: STAT_* phase
+ * @start: value of STAT_START() when the phase began
+ *
+ * Called through STAT_RECORD, which skips the call when neither the
+ * histograms nor the trace are on. The phase is also a trace event.
+ */
+void stat_record(int phase, long long start)
+{
+	histogram_t *histogram = &histograms[phase];
+	long long end = monotonic_ns();
+	unsigned long long value = end - start;
+
+	if (trace_enabled)
+		trace_phase(phase, start, end);
+	if (!stats_enabled)
+		return;
+
+	histogram->count++;
+	histogram->total += value;
+	if (value > histogram->max)
+		histogram->max = value;
+	histogram->buckets[stat_bucket(value)]++;
+}
+
+/**
+ * stat_percentile - reads a percentile from a histogram
+ * @histogram: histogram to read
+ * @percent: percentile wanted, 0 to 100
+ * Return: upper bound of the bucket holding the percentile, clamped
+ * to the largest sample
+ */
+static unsigned long long stat_percentile(histogram_t *histogram, int percent)
+{
+	unsigned long target, seen = 0;
+	int i;
+
+	target = (histogram->count * percent + 99) / 100;
+	if (target == 0)
+		target = 1;
+	for (i = 0; i < STAT_BUCKETS; i++)
+	{
+		seen += histogram->buckets[i];
+		if (seen >= target)
+			break;
+	}
+	if (i == STAT_BUCKETS || stat_bucket_value(i) > histogram->max)
+		return (histogram->max);
+	return (stat_bucket_value(i));
+}
+
+/**
+ * print_duration - prints a duration in a readable unit
+ * @ns: duration in nanoseconds
+ */
+static void print_duration(unsigned long long ns)
+{
+	char text[32];
+	int len;
+
+	if (ns < 1000)
+		len = snprintf(text, sizeof(text), "%10lluns", ns);
+	else if (ns < 1000000)
+		len = snprintf(text, sizeof(text), "%10.1fus", ns / 1e3);
+	else if (ns < 1000000000)
+		len = snprintf(text, sizeof(text), "%10.1fms", ns / 1e6);
+	else
+		len = snprintf(text, sizeof(text), "%10.2fs ", ns / 1e9);
+	buffer_write(text, len);
+}
+
+/**
+ * print_stats - prints the histograms and counters
+ */
+static void print_stats(void)
+{
+	unsigned long aliases, alias_ns;
+	char line[64];
+	int i, len;
+
+	buffer_puts("phase        count         p50         p99         max\n");
+	for (i = 0; i < STAT_PHASES; i++)
+	{
+		len = snprintf(line, sizeof(line), "%-8s%10lu", phase_names[i],
+			       histograms[i].count);
+		buffer_write(line, len);
+		print_duration(stat_percentile(&histograms[i], 50));
+		print_duration(stat_percentile(&histograms[i], 99));
+		print_duration(histograms[i].max);
+		buffer_write("\n", 1);
+	}
+
+	for (i = 0; i < STAT_COUNTERS; i++)
+	{
+		len = snprintf(line, sizeof(line), "%-8s%10lu\n", counter_names[i],
+			       stat_counters[i]);
+		buffer_write(line, len);
+	}
+	alias_expansion_stats(&aliases, &alias_ns);
+	len = snprintf(line, sizeof(line), "%-8s%10lu", "aliases", aliases);
+	buffer_write(line, len);
+	print_duration(aliases != 0 ? alias_ns / aliases : 0);
+	buffer_puts(" mean\n");
+}
+
+/**
+ * shellstat_builtin - implements the shellstat builtin
+ * @argc: number of arguments
+ * @argv: command arguments
+ * @io: descriptors of the builtin
+ *
+ * Without arguments the p50, p99 and maximum latency of each phase
+ * are printed along with the event counters. on and off start and
+ * stop taking timestamps, and reset clears everything.
+ * Return: 0 on success, 1 on bad usage
+ */
+int shellstat_builtin(int argc, char **argv, builtin_io_t *io)
+{
+	if (argc == 1)
+	{
+		if (!stats_enabled)
+			buffer_puts("(histograms off: shellstat on or SHELL_STATS=1)\n");
+		print_stats();
+		return (0);
+	}
+
+	if (argc == 2 && strcmp(argv[1], "on") == 0)
+		stats_enabled = 1;
+	else if (argc == 2 && strcmp(argv[1], "off") == 0)
+		stats_enabled = 0;
+	else if (argc == 2 && strcmp(argv[1], "reset") == 0)
+	{
+		memset(histograms, 0, sizeof(histograms));
+		memset(stat_counters, 0, sizeof(stat_counters));
+	}
+	else
+	{
+		write(io->err, "Usage: shellstat [on|off|reset]\n", 32);
+		return (1);
+	}
+	return (0);
+}
@@ -0,0 +1,79 @@
+#!/bin/bash
+
+# Check script lines against /bin/sh
+# Usage: ./syntax_test.sh ./hsh
+#
+# Every case is run as a one-line script by the shell and by /bin/sh,
+# in a scratch directory, and their output compared.
+# Most cases use syntax the plan compiler handles itself, quotes,
+# backslashes and $ inside a word, or leaves to /bin/sh: globs, command
+# substitution and redirections of other descriptors.
+# The state cases change the shell itself, which /bin/sh cannot show,
+# so their output is checked against what they must print.
+
+shell=$(realpath "${1:?usage: $0 SHELL}")
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+cd "$dir" || exit 1
+touch a.sh b.sh c.txt
+
+cases=(
+	'echo "hello world"'
+	"echo 'single \$HOME'"
+	'echo a\ b'
+	'ls *.sh'
+	'ls ?.txt'
+	'echo $HOME/x'
+	'echo ${HOME}'
+	'ls /nonexistent 2>/dev/null; echo $?'
+	'ls /nonexistent 2>&1 | wc -l'
+	'echo "a;b" && echo c'
+	'echo $(echo nested)'
+	'echo plain $HOME | cat'
+	'echo ok > out; cat out'
+	'false; echo $?'
+	'X=1; echo "$X"'
+	'echo "$HOME"x x"$HOME" "" a\"b'
+	'E=; printf "[%s]\n" "$E" $E'
+	'cd ~; pwd'
+)
+
+# Script, then the output it must print
+state=(
+	$'alias lx=\'echo hi there\'\nlx'	'hi there'
+	$'cd ~\npwd'	"$HOME"
+	$'cd ~/..\npwd'	"$(dirname "$HOME")"
+	$'setenv FOO "a b"\nenv | grep ^FOO='	'FOO=a b'
+	$'X="a  b"\necho "$X"'	'a  b'
+	$'X=1; echo "$X"'	'1'
+	$'Y=~/bin\necho $Y'	"$HOME/bin"
+	$'alias g=*.sh\necho $?'	$'alias: unsupported syntax\n2'
+	$'Z=$(echo 1)\necho "[$Z]"'	$'Z: unsupported syntax\n[]'
+)
+
+failed=0
+for line in "${cases[@]}"; do
+	printf '%s\n' "$line" > script
+	expected=$(/bin/sh script 2>&1)
+	actual=$("$shell" script 2>&1)
+	if [ "$expected" = "$actual" ]; then
+		printf 'ok    %s\n' "$line"
+	else
+		printf 'FAIL  %s\n' "$line"
+		diff <(echo "$expected") <(echo "$actual") | sed 's/^/      /'
+		failed=1
+	fi
+done
+
+for ((i = 0; i < ${#state[@]}; i += 2)); do
+	printf '%s\n' "${state[i]}" > script
+	actual=$("$shell" script 2>&1)
+	if [ "${state[i + 1]}" = "$actual" ]; then
+		printf 'ok    %s\n' "${state[i]//$'\n'/; }"
+	else
+		printf 'FAIL  %s\n' "${state[i]//$'\n'/; }"
+		diff <(echo "${state[i + 1]}") <(echo "$actual") | sed 's/^/      /'
+		failed=1
+	fi
+done
+exit $failed
@@ -0,0 +1,326 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include "main.h"
+
+#define TIMEOUT_KILL_AFTER 1000000000LL
+
+/**
+ * struct signal_name - a signal the timeout can be asked to send
+ * @name: name without the SIG prefix
+ * @number: signal number
+ */
+typedef struct signal_name
+{
+	const char *name;
+	int number;
+} signal_name_t;
+
+static const signal_name_t signal_names[] = {
+	{"HUP", SIGHUP}, {"INT", SIGINT}, {"QUIT", SIGQUIT},
+	{"KILL", SIGKILL}, {"USR1", SIGUSR1}, {"USR2", SIGUSR2},
+	{"ALRM", SIGALRM}, {"TERM", SIGTERM}, {"CONT", SIGCONT},
+	{"STOP", SIGSTOP},
+};
+
+/**
+ * monotonic_ns - reads the monotonic clock
+ * Return: current time in nanoseconds
+ */
+long long monotonic_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec * 1000000000LL + now.tv_nsec);
+}
+
+/**
+ * parse_duration - converts a duration to nanoseconds
+ * @text: a decimal number with an optional ms, s, m, h or d suffix;
+ * seconds without a suffix
+ * @ns: set to the duration
+ * Return: 0 on success, -1 if @text is not a duration
+ */
+int parse_duration(const char *text, long long *ns)
+{
+	long long whole = 0, fraction = 0, scale = 1, unit = 1000000000LL;
+	const char *p = text;
+
+	if (*p < '0' || *p > '9')
+		return (-1);
+	while (*p >= '0' && *p <= '9')
+		whole = whole * 10 + (*p++ - '0');
+	if (*p == '.')
+	{
+		for (p++; *p >= '0' && *p <= '9'; p++)
+		{
+			if (scale < 1000000000LL)
+			{
+				fraction = fraction * 10 + (*p - '0');
+				scale *= 10;
+			}
+		}
+	}
+
+	if (strcmp(p, "ms") == 0)
+		unit = 1000000LL;
+	else if (strcmp(p, "m") == 0)
+		unit *= 60;
+	else if (strcmp(p, "h") == 0)
+		unit *= 3600;
+	else if (strcmp(p, "d") == 0)
+		unit *= 86400;
+	else if (*p != '\0' && strcmp(p, "s") != 0)
+		return (-1);
+
+	*ns = whole * unit + fraction * unit / scale;
+	return (0);
+}
+
+/**
+ * parse_signal - converts a signal name or number
+ * @text: TERM, SIGTERM or 15, for instance
+ * Return: the signal number, -1 if @text is not a known signal
+ */
+int parse_signal(const char *text)
+{
+	char *end;
+	long number;
+	size_t i;
+
+	if (strncmp(text, "SIG", 3) == 0)
+		text += 3;
+	for (i = 0; i < sizeof(signal_names) / sizeof(*signal_names); i++)
+	{
+		if (strcmp(signal_names[i].name, text) == 0)
+			return (signal_names[i].number);
+	}
+
+	number = strtol(text, &end, 10);
+	if (end == text || *end != '\0' || number <= 0 || number >= NSIG)
+		return (-1);
+	return (number);
+}
+
+/**
+ * deadline_default - applies the shell-wide timeout of commands
+ * @deadline: deadline to set up
+ *
+ * SHELL_TIMEOUT is a duration after which a foreground command is
+ * sent SHELL_TIMEOUT_SIGNAL (TERM by default). The deadline is left
+ * unarmed when SHELL_TIMEOUT is unset or invalid.
+ */
+void deadline_default(deadline_t *deadline)
+{
+	char *timeout = env_get("SHELL_TIMEOUT");
+	char *name = env_get("SHELL_TIMEOUT_SIGNAL");
+	long long ns;
+	int signal = SIGTERM;
+
+	if (name != NULL && parse_signal(name) != -1)
+		signal = parse_signal(name);
+	if (timeout == NULL || parse_duration(timeout, &ns) == -1)
+		ns = 0;
+	deadline_init(deadline, ns, signal, TIMEOUT_KILL_AFTER);
+}
+
+/**
+ * deadline_init - arms a deadline from now
+ * @deadline: deadline to set up
+ * @timeout: time allowed, in nanoseconds, 0 for none
+ * @signal: signal sent when @timeout passes
+ * @kill_after: time allowed after @signal before SIGKILL, 0 for none
+ */
+void deadline_init(deadline_t *deadline, long long timeout, int signal,
+		   long long kill_after)
+{
+	deadline->group = 0;
+	deadline->expires = timeout > 0 ? monotonic_ns() + timeout : 0;
+	deadline->kill_after = kill_after;
+	deadline->signal = signal;
+	deadline->expired = 0;
+}
+
+/**
+ * deadline_expire - signals the commands of an expired deadline
+ * @deadline: deadline that passed
+ *
+ * The first expiry sends the configured signal to the whole process
+ * group, so a pipeline or a command's own children go with it; the
+ * deadline is then pushed back by the kill-after delay, and expiring
+ * again sends SIGKILL.
+ */
+static void deadline_expire(deadline_t *deadline)
+{
+	int signal = deadline->expired ? SIGKILL : deadline->signal;
+
+	if (deadline->group > 0)
+		killpg(deadline->group, signal);
+
+	deadline->expires = 0;
+	if (!deadline->expired && signal != SIGKILL && deadline->kill_after > 0)
+		deadline->expires = monotonic_ns() + deadline->kill_after;
+	deadline->expired = 1;
+}
+
+/**
+ * deadline_terminal - gives the terminal to a timed command's group
+ * @group: process group of the command, 0 to take the terminal back
+ *
+ * A command in a process group of its own is in the background as far
+ * as the terminal is concerned, and is stopped by SIGTTIN as soon as
+ * it reads from it. When the shell runs in the foreground of its
+ * terminal, the group is made the foreground one and continued, in
+ * case it was stopped before it got there. The shell is then in the
+ * background itself and takes the terminal back with SIGTTOU blocked.
+ */
+void deadline_terminal(pid_t group)
+{
+	static pid_t shell_group = -1;
+	sigset_t block, old;
+
+	if (group > 0)
+	{
+		if (!is_interactive() || tcgetpgrp(STDIN_FILENO) != getpgrp())
+			return;
+		shell_group = getpgrp();
+		if (tcsetpgrp(STDIN_FILENO, group) == 0)
+			killpg(group, SIGCONT);
+		return;
+	}
+	if (shell_group == -1)
+		return;
+
+	sigemptyset(&block);
+	sigaddset(&block, SIGTTOU);
+	sigprocmask(SIG_BLOCK, &block, &old);
+	tcsetpgrp(STDIN_FILENO, shell_group);
+	sigprocmask(SIG_SETMASK, &old, NULL);
+	shell_group = -1;
+}
+
+/**
+ * deadline_wait - waits for a child until a deadline passes
+ * @deadline: deadline of the command, NULL or unarmed for none
+ * @pid: child to wait for
+ * @status: set to the wait status of the child
+ * @usage: resource usage of the child is added here, NULL to drop it
+ *
+ * The child's pidfd is polled with the time left, so the shell sleeps
+ * in the kernel until the child exits or the deadline passes: no
+ * helper process, timer signal or polling loop. Without pidfds the
+ * child is waited for without a deadline.
+ */
+void deadline_wait(deadline_t *deadline, pid_t pid, int *status,
+		   struct rusage *usage)
+{
+	struct pollfd pfd;
+	long long left;
+	int ready;
+
+	pfd.fd = -1;
+	if (deadline != NULL && deadline->expires != 0)
+		pfd.fd = syscall(SYS_pidfd_open, pid, 0);
+	if (pfd.fd == -1)
+	{
+		wait_for_child_usage(pid, status, usage);
+		return;
+	}
+
+	pfd.events = POLLIN;
+	do {
+		left = -1;
+		if (deadline->expires != 0)
+		{
+			left = deadline->expires - monotonic_ns();
+			/* Round up so the poll never returns early */
+			left = left > 0 ? (left + 999999) / 1000000 : 0;
+		}
+		if (left > 0x7fffffff)
+			left = 0x7fffffff;
+
+		ready = poll(&pfd, 1, left);
+		if (ready == 0 && deadline->expires != 0
+		    && deadline->expires <= monotonic_ns())
+			deadline_expire(deadline);
+	} while (ready == 0 || (ready == -1 && errno == EINTR));
+	close(pfd.fd);
+
+	wait_for_child_usage(pid, status, usage);
+}
+
+/**
+ * timeout_builtin - implements the timeout builtin
+ * @argc: number of arguments
+ * @argv: command arguments
+ * @io: descriptors of the builtin
+ *
+ * timeout [-s SIGNAL] [-k DURATION] DURATION COMMAND [ARG...] runs
+ * COMMAND in its own process group, in the foreground of the terminal
+ * when there is one, and sends it SIGNAL (TERM by default) once
+ * DURATION has passed, then SIGKILL after the -k delay (one second by
+ * default, 0 to never escalate).
+ * Return: exit status of the command, 124 if it timed out, 125 on bad
+ * usage, 127 if it was not found
+ */
+int timeout_builtin(int argc, char **argv, builtin_io_t *io)
+{
+	long long timeout, kill_after = TIMEOUT_KILL_AFTER;
+	int i = 1, signal = SIGTERM, status;
+	deadline_t deadline;
+	char *path;
+	pid_t pid;
+
+	for (; i + 1 < argc && argv[i][0] == '-'; i += 2)
+	{
+		if (strcmp(argv[i], "-s") == 0)
+			signal = parse_signal(argv[i + 1]);
+		else if (strcmp(argv[i], "-k") != 0
+			 || parse_duration(argv[i + 1], &kill_after) == -1)
+			signal = -1;
+		if (signal == -1)
+			break;
+	}
+	if (signal == -1 || i + 1 >= argc
+	    || parse_duration(argv[i], &timeout) == -1)
+	{
+		write(io->err, "Usage: timeout [-s SIGNAL] [-k DURATION] "
+		      "DURATION COMMAND [ARG...]\n", 67);
+		return (125);
+	}
+
+	argv += i + 1;
+	path = find_command(argv[0]);
+	if (path == NULL)
+	{
+		write(io->err, "Command not found\n", 18);
+		return (127);
+	}
+	argv[0] = path;
+
+	spawn_process_group(0);
+	pid = spawn_command(argv, NULL, io->in, io->out);
+	spawn_process_group(-1);
+	if (pid == -1)
+	{
+		perror("fork");
+		return (125);
+	}
+	if (pid == 0)
+		return (126);
+
+	deadline_init(&deadline, timeout, signal, kill_after);
+	deadline.group = pid;
+	deadline_terminal(pid);
+	deadline_wait(&deadline, pid, &status, NULL);
+	deadline_terminal(0);
+	if (deadline.expired)
+		return (124);
+	if (WIFSIGNALED(status))
+		return (128 + WTERMSIG(status));
+	return (WEXITSTATUS(status));
+}
@@ -0,0 +1,92 @@
+#include "main.h"
+
+/**
+ * count_args - counts the words of a command line
+ * @input: command line
+ * Return: number of words separated by spaces, tabs or newlines
+ */
+int count_args(char *input)
+{
+	int count = 0, in_word = 0, i;
+
+	for (i = 0; input[i] != '\0'; i++)
+	{
+		if (input[i] != ' ' && input[i] != '\t' && input[i] != '\n')
+		{
+			if (in_word == 0)
+			{
+				in_word = 1;
+				count++;
+			}
+		}
+		else
+		{
+			in_word = 0;
+		}
+	}
+	return (count);
+}
+
+/**
+ * split_words - splits a command line without strtok
+ * @input: command line, cut into words in place
+ *
+ * The words are counted first, so the vector is allocated once at
+ * its exact size.
+ * Return: NULL-terminated argument vector, allocated in the arena
+ */
+char **split_words(char *input)
+{
+	char **args = arena_alloc((count_args(input) + 1) * sizeof(*args));
+	int arg_index = 0, in_word = 0, i;
+
+	for (i = 0; input[i] != '\0'; i++)
+	{
+		if (input[i] != ' ' && input[i] != '\t' && input[i] != '\n')
+		{
+			if (in_word == 0)
+			{
+				in_word = 1;
+				args[arg_index++] = &input[i];
+			}
+		}
+		else
+		{
+			in_word = 0;
+			input[i] = '\0';
+		}
+	}
+
+	/* Null-terminate the last argument */
+	args[arg_index] = NULL;
+	return (args);
+}
+
+/**
+ * strtok_words - splits a command line at spaces with strtok
+ * @input: command line, cut into words in place
+ * Return: NULL-terminated argument vector, allocated in the arena
+ */
+char **strtok_words(char *input)
+{
+	size_t size = MAX_NUM_ARGS, i = 0;
+	char **args = arena_alloc(size * sizeof(*args));
+	char **grown;
+	char *arg = strtok(input, " ");
+
+	while (arg != NULL)
+	{
+		/* Grow the argument vector instead of truncating the command */
+		if (i == size - 1)
+		{
+			grown = arena_alloc(2 * size * sizeof(*args));
+			memcpy(grown, args, i * sizeof(*args));
+			args = grown;
+			size *= 2;
+		}
+		args[i++] = arg;
+		arg = strtok(NULL, " ");
+	}
+	args[i] = NULL;
+	return (args);
+}
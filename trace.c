@@ -0,0 +1,274 @@
+#include <fcntl.h>
+#include "main.h"
+
+#define TRACE_EVENTS 4096
+#define TRACE_DETAIL 40
+#define TRACE_OUTPUT (64 * 1024)
+#define TRACE_DEFAULT_FILE "shell-trace.json"
+
+/**
+ * struct trace_event - one recorded event
+ * @start: CLOCK_MONOTONIC time of the event, in ns
+ * @end: end of a complete event, in ns
+ * @tid: track of the event: the shell's pid, or a child's
+ * @type: 'X' for a complete event, 'B' or 'E' for a child's life
+ * @phase: STAT_* phase of a complete event
+ * @detail: command the event belongs to, truncated
+ */
+typedef struct trace_event
+{
+	long long start;
+	long long end;
+	pid_t tid;
+	char type;
+	char phase;
+	char detail[TRACE_DETAIL];
+} trace_event_t;
+
+int trace_enabled;
+static int trace_fd = -1;
+static pid_t trace_pid;
+static int trace_written;
+static char trace_detail[TRACE_DETAIL];
+
+/*
+ * The ring is only ever written by the shell's single thread and
+ * drained by it when full, so head and tail need no lock. A forked
+ * child gets its own copy, which it never writes out.
+ */
+static trace_event_t trace_ring[TRACE_EVENTS];
+static unsigned int trace_head;
+static unsigned int trace_tail;
+
+static const char *const trace_names[STAT_PHASES] = {
+	"parse", "lookup", "spawn", "reap", "builtin", "expand"
+};
+
+/**
+ * trace_escape - copies text into a JSON string body
+ * @dest: destination
+ * @src: text to copy
+ * @len: length of @src
+ * @size: size of @dest
+ *
+ * Quotes, backslashes and control characters are replaced, as the
+ * text is only a label.
+ */
+static void trace_escape(char *dest, const char *src, size_t len,
+			 size_t size)
+{
+	size_t i;
+
+	for (i = 0; i + 1 < size && i < len; i++)
+	{
+		dest[i] = src[i];
+		if (src[i] == '"' || src[i] == '\\' || (unsigned char)src[i] < ' ')
+			dest[i] = '?';
+	}
+	dest[i] = '\0';
+}
+
+/**
+ * trace_format - formats one event as Chrome trace JSON
+ * @event: event to format
+ * @text: destination
+ * @size: size of @text
+ *
+ * A child's begin event also names its track after the command.
+ * Return: number of bytes written to @text
+ */
+static int trace_format(trace_event_t *event, char *text, size_t size)
+{
+	int len = 0;
+
+	if (event->type == 'B')
+		len = snprintf(text, size, "{\"name\":\"thread_name\",\"ph\":\"M\","
+			       "\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s [%d]\"}},\n",
+			       (int)trace_pid, (int)event->tid, event->detail,
+			       (int)event->tid);
+	if (event->type == 'X')
+		len += snprintf(text + len, size - len, "{\"name\":\"%s\",\"ph\":\"X\","
+				"\"ts\":%.3f,\"dur\":%.3f,",
+				trace_names[(int)event->phase], event->start / 1e3,
+				(event->end - event->start) / 1e3);
+	else
+		len += snprintf(text + len, size - len, "{\"name\":\"%s\",\"ph\":\"%c\","
+				"\"ts\":%.3f,", event->detail, event->type,
+				event->start / 1e3);
+	len += snprintf(text + len, size - len,
+			"\"pid\":%d,\"tid\":%d,\"args\":{\"command\":\"%s\"}}",
+			(int)trace_pid, (int)event->tid, event->detail);
+	return (len);
+}
+
+/**
+ * trace_drain - writes the recorded events out and empties the ring
+ *
+ * A forked child shares the trace file with the shell; the events it
+ * records are dropped rather than written in the middle of the
+ * shell's.
+ */
+static void trace_drain(void)
+{
+	char output[TRACE_OUTPUT];
+	size_t used = 0;
+	int len;
+
+	if (trace_fd == -1)
+		return;
+	if (getpid() != trace_pid)
+	{
+		trace_tail = trace_head;
+		return;
+	}
+	if (!trace_written)
+	{
+		used = snprintf(output, sizeof(output), "{\"traceEvents\":[\n"
+				"{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+				"\"args\":{\"name\":\"shell\"}}", (int)trace_pid);
+		trace_written = 1;
+	}
+
+	for (; trace_tail != trace_head; trace_tail++)
+	{
+		/* Room for a separator and the largest formatted event */
+		if (used + 512 > sizeof(output))
+		{
+			write(trace_fd, output, used);
+			used = 0;
+		}
+		output[used++] = ',';
+		output[used++] = '\n';
+		len = trace_format(&trace_ring[trace_tail % TRACE_EVENTS],
+				   output + used, sizeof(output) - used);
+		used += len;
+	}
+	write(trace_fd, output, used);
+}
+
+/**
+ * trace_push - appends an event to the ring
+ * @type: 'X', 'B' or 'E'
+ * @phase: STAT_* phase of a complete event
+ * @tid: track of the event
+ * @start: start of the event, in ns
+ * @end: end of the event, in ns
+ *
+ * The ring is drained to the trace file when it fills up, so no event
+ * is lost however long the script runs.
+ */
+static void trace_push(char type, int phase, pid_t tid, long long start,
+		       long long end)
+{
+	trace_event_t *event;
+
+	if (trace_head - trace_tail == TRACE_EVENTS)
+		trace_drain();
+
+	event = &trace_ring[trace_head % TRACE_EVENTS];
+	event->type = type;
+	event->phase = phase;
+	event->tid = tid;
+	event->start = start;
+	event->end = end;
+	memcpy(event->detail, trace_detail, TRACE_DETAIL);
+	trace_head++;
+}
+
+/**
+ * trace_command - names the command the next events belong to
+ * @text: command name or line
+ * @len: length of @text
+ */
+void trace_command(const char *text, size_t len)
+{
+	trace_escape(trace_detail, text, len, TRACE_DETAIL);
+}
+
+/**
+ * trace_phase - records a phase of the shell's own work
+ * @phase: STAT_* phase
+ * @start: start of the phase, in ns
+ * @end: end of the phase, in ns
+ */
+void trace_phase(int phase, long long start, long long end)
+{
+	trace_push('X', phase, trace_pid, start, end);
+}
+
+/**
+ * trace_child - records the start or the end of a child's life
+ * @pid: the child
+ * @begin: 1 when it was started, 0 when it was reaped
+ *
+ * Each child gets a track of its own, on which it shows as running
+ * from spawn to reap.
+ */
+void trace_child(pid_t pid, int begin)
+{
+	if (!trace_enabled || pid <= 0)
+		return;
+	trace_push(begin ? 'B' : 'E', 0, pid, monotonic_ns(), 0);
+}
+
+/**
+ * trace_finish - writes the remaining events and closes the trace
+ */
+void trace_finish(void)
+{
+	if (trace_fd == -1)
+		return;
+	/* Only the shell writes the file, not a child exiting through exit */
+	if (getpid() == trace_pid)
+	{
+		trace_drain();
+		write(trace_fd, "\n]}\n", 4);
+	}
+	close(trace_fd);
+	trace_fd = -1;
+	trace_enabled = 0;
+}
+
+/**
+ * trace_start - starts recording a trace
+ *
+ * The trace is written to $SHELL_TRACE, or shell-trace.json in the
+ * current directory, when tracing stops or the shell exits.
+ * Return: 0 on success, -1 if the file could not be opened
+ */
+int trace_start(void)
+{
+	static int registered;
+	char *file = env_get("SHELL_TRACE");
+
+	if (trace_fd != -1)
+		return (0);
+	if (file == NULL || *file == '\0')
+		file = TRACE_DEFAULT_FILE;
+	trace_fd = open(file, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+	if (trace_fd == -1)
+	{
+		perror(file);
+		return (-1);
+	}
+
+	if (!registered)
+		atexit(trace_finish);
+	registered = 1;
+	trace_pid = getpid();
+	trace_written = 0;
+	trace_head = trace_tail = 0;
+	trace_enabled = 1;
+	return (0);
+}
+
+/**
+ * trace_init - starts tracing at startup when SHELL_TRACE is set
+ */
+void trace_init(void)
+{
+	char *file = env_get("SHELL_TRACE");
+
+	if (file != NULL && *file != '\0')
+		trace_start();
+}
@@ -0,0 +1,129 @@
+#include "main.h"
+
+#define USAGE_LINE 512
+
+/**
+ * usage_seconds - converts a timeval to seconds
+ * @tv: time to convert
+ * Return: @tv in seconds
+ */
+static double usage_seconds(struct timeval tv)
+{
+	return (tv.tv_sec + tv.tv_usec / 1e6);
+}
+
+/**
+ * timeval_add - adds one time to another
+ * @total: time added to
+ * @tv: time to add
+ */
+static void timeval_add(struct timeval *total, struct timeval tv)
+{
+	total->tv_sec += tv.tv_sec;
+	total->tv_usec += tv.tv_usec;
+	if (total->tv_usec >= 1000000)
+	{
+		total->tv_sec++;
+		total->tv_usec -= 1000000;
+	}
+}
+
+/**
+ * timeval_sub - subtracts one time from another
+ * @total: time subtracted from
+ * @tv: time to subtract
+ */
+static void timeval_sub(struct timeval *total, struct timeval tv)
+{
+	total->tv_sec -= tv.tv_sec;
+	total->tv_usec -= tv.tv_usec;
+	if (total->tv_usec < 0)
+	{
+		total->tv_sec--;
+		total->tv_usec += 1000000;
+	}
+}
+
+/**
+ * usage_add - accumulates the resource usage of a reaped child
+ * @total: usage added to
+ * @usage: usage of the child, as returned by wait4
+ *
+ * Times and counters are summed; the peak resident set size is the
+ * largest of any process, as the processes of a pipeline each have
+ * their own.
+ */
+void usage_add(struct rusage *total, const struct rusage *usage)
+{
+	timeval_add(&total->ru_utime, usage->ru_utime);
+	timeval_add(&total->ru_stime, usage->ru_stime);
+	if (usage->ru_maxrss > total->ru_maxrss)
+		total->ru_maxrss = usage->ru_maxrss;
+	total->ru_majflt += usage->ru_majflt;
+	total->ru_minflt += usage->ru_minflt;
+	total->ru_nvcsw += usage->ru_nvcsw;
+	total->ru_nivcsw += usage->ru_nivcsw;
+}
+
+/**
+ * usage_since - adds what the shell itself used since a snapshot
+ * @total: usage added to
+ * @before: getrusage(RUSAGE_SELF) taken before the command
+ *
+ * This covers builtins run in the shell and the cost of starting the
+ * children. The shell's peak resident set size is only reported
+ * when no child ran, since it is not the command's.
+ */
+void usage_since(struct rusage *total, const struct rusage *before)
+{
+	struct rusage self;
+
+	getrusage(RUSAGE_SELF, &self);
+	timeval_sub(&self.ru_utime, before->ru_utime);
+	timeval_sub(&self.ru_stime, before->ru_stime);
+	self.ru_majflt -= before->ru_majflt;
+	self.ru_minflt -= before->ru_minflt;
+	self.ru_nvcsw -= before->ru_nvcsw;
+	self.ru_nivcsw -= before->ru_nivcsw;
+	if (total->ru_maxrss != 0)
+		self.ru_maxrss = 0;
+	usage_add(total, &self);
+}
+
+/**
+ * usage_report - prints the resources a timed command used
+ * @fd: descriptor to print to
+ * @wall: elapsed time in nanoseconds
+ * @usage: accumulated usage of the command
+ * @status: exit status of the command
+ * @json: 1 for a single JSON object, 0 for one line per measure
+ */
+void usage_report(int fd, long long wall, const struct rusage *usage,
+		  int status, int json)
+{
+	char line[USAGE_LINE];
+	int len;
+
+	if (json)
+		len = snprintf(line, sizeof(line),
+			       "{\"real\":%.6f,\"user\":%.6f,\"sys\":%.6f,"
+			       "\"maxrss_kib\":%ld,\"major_faults\":%ld,"
+			       "\"minor_faults\":%ld,\"voluntary_switches\":%ld,"
+			       "\"involuntary_switches\":%ld,\"status\":%d}\n",
+			       wall / 1e9, usage_seconds(usage->ru_utime),
+			       usage_seconds(usage->ru_stime), usage->ru_maxrss,
+			       usage->ru_majflt, usage->ru_minflt,
+			       usage->ru_nvcsw, usage->ru_nivcsw, status);
+	else
+		len = snprintf(line, sizeof(line),
+			       "real\t%.3fs\nuser\t%.3fs\nsys\t%.3fs\n"
+			       "maxrss\t%ld KiB\n"
+			       "faults\t%ld major, %ld minor\n"
+			       "switches\t%ld voluntary, %ld involuntary\n",
+			       wall / 1e9, usage_seconds(usage->ru_utime),
+			       usage_seconds(usage->ru_stime), usage->ru_maxrss,
+			       usage->ru_majflt, usage->ru_minflt,
+			       usage->ru_nvcsw, usage->ru_nivcsw);
+	if (len > 0)
+		write(fd, line, len < USAGE_LINE ? len : USAGE_LINE - 1);
+}
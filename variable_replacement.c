@@ -13,7 +13,8 @@
  */
 void print_prompt(void)
 {
-	write(STDOUT_FILENO, "$ ", 2);
+	if (is_interactive())
+		write(STDOUT_FILENO, "$ ", 2);
 }
 
 /**
@@ -23,62 +24,42 @@ void print_prompt(void)
  */
 ssize_t read_input(char *input)
 {
-	ssize_t read_size = read(STDIN_FILENO, input, MAX_INPUT_LENGTH);
-
-	if (read_size == -1)
-	{
-		perror("read");
-		exit(EXIT_FAILURE);
-	}
-	else if (read_size == 0)
-	{
-		write(STDOUT_FILENO, "\n", 1);
-		exit(EXIT_SUCCESS);
-	}
-	/* Remove newline character from end of command */
-	input[read_size - 1] = '\0';
+	ssize_t read_size = read_line(input, MAX_INPUT_LENGTH);
 	return (read_size);
 }
 
 /**
- * execute_command - executes command
+ * run_command - executes a one-word command
  * @command: command to execute
- * @environ: environment variables
+ * Return: wait status of the command, 127 << 8 if it was not found
  */
-void execute_command(char *command, char **environ)
+int run_command(char *command)
 {
-	pid_t pid = fork();
-	int status;
+	char *args[] = {command, NULL};
+	pid_t pid;
+	int status = 127 << 8;
 
+	if (access(command, F_OK) == -1)
+	{
+		write(STDERR_FILENO, "Command not found\n", 18);
+		return (status);
+	}
+
+	pid = spawn_command(args, NULL, -1, -1);
 	if (pid == -1)
 	{
 		perror("fork");
 		exit(EXIT_FAILURE);
 	}
-	else if (pid == 0)
+	else if (pid > 0)
 	{
-		/* Child process */
-		/* Execute command */
-		if (access(command, F_OK) != -1)
-		{
-			execve(command, NULL, environ);
-			perror("execve");
-			_exit(EXIT_FAILURE);
-		}
-		else
-		{
-			write(STDERR_FILENO, "Command not found\n", 18);
-				_exit(EXIT_FAILURE);
-		}
-	}
-	else
-	{
-		/* Parent process */
 		/* Wait for child process to complete */
-		do {
-			waitpid(pid, &status, WUNTRACED);
-		} while (!WIFEXITED(status) && !WIFSIGNALED(status));
+		wait_for_child(pid, &status);
 	}
+	else
+		status = 126 << 8;
+
+	return (status);
 }
 
 /**
@@ -88,9 +69,10 @@ void execute_command(char *command, char **environ)
  * @argv: argument vector
  * Return: 0 on success, non-zero on failure
  */
-int main(int argc, char **argv, char **environ)
+int main(int argc, char **argv)
 {
 	char input[MAX_INPUT_LENGTH];
+	int status = 0;
 
 	while (1)
 	{
@@ -99,15 +81,19 @@ int main(int argc, char **argv, char **environ)
 
 		if (strcmp(input, "$?") == 0)
 		{
-			printf("%d\n", WEXITSTATUS(status));
+			buffer_put_number(WEXITSTATUS(status));
+			buffer_write("\n", 1);
+			buffer_flush();
 		}
 		else if (strcmp(input, "$$") == 0)
 		{
-			printf("%d\n", getpid());
+			buffer_put_number(getpid());
+			buffer_write("\n", 1);
+			buffer_flush();
 		}
 		else
 		{
-			execute_command(input, environ);
+			status = run_command(input);
 		}
 	}
 	return (0);